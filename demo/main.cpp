@@ -3,12 +3,92 @@
 #include <chrono>
 #include "../lia/dense/static.h"
 #include "../lia/dense/dynamic.h"
+#include "../lia/io/text.h"
 #include <stdlib.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#endif
 
 #define VEC_SIZE    2
 #define ITERATIONS  10000000
 #define TEST_COUNT  100
 
+#define TEXT_LINES  250000
+#define TEXT_COLUMNS 16
+#define TEXT_RUNS   10
+
+#define TLB_LINES   4096
+#define TLB_COLUMNS 8192
+#define TLB_RUNS    20
+
+#ifdef __linux__
+// Open a counter of the data TLB read misses of the calling thread, returns -1 if the machine has none
+static int openTLBCounter() {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Get the amount of anonymous memory of the process backed by transparent huge pages in kB
+static long anonHugePages() {
+    FILE* fp = fopen("/proc/self/smaps_rollup", "r");
+    if (!fp) { return -1; }
+    char line[256];
+    long kb = -1;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) { break; }
+    }
+    fclose(fp);
+    return kb;
+}
+
+// Time a large matrix-vector product and count its TLB misses with a given allocation policy
+static void benchTLB(lia::Alloc policy, const char* name) {
+    lia::DMatd a(TLB_LINES, TLB_COLUMNS, policy);
+    lia::DVecd x(TLB_COLUMNS);
+    lia::DVecd y(TLB_LINES);
+    lia::clear(a, 0.5);
+    lia::clear(x, 1.0);
+    const long huge = anonHugePages();
+
+    // Warm up, then measure
+    lia::dot(y, a, x);
+    int fd = openTLBCounter();
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < TLB_RUNS; i++) { lia::dot(y, a, x); }
+    auto end = std::chrono::high_resolution_clock::now();
+    uint64_t misses = 0;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(uint64_t)) != sizeof(uint64_t)) { misses = 0; }
+        close(fd);
+    }
+
+    // Only the calling thread is counted, run with LIA_THREADS=1 to count the whole product
+    printf("%s: %lf ms/dot, %ld kB huge pages, ", name, (end - begin).count() / 1e6 / (double)TLB_RUNS, huge);
+    if (fd >= 0) {
+        printf("%" PRIu64 " dTLB-load-misses/dot\n", misses / TLB_RUNS);
+    }
+    else {
+        printf("dTLB-load-misses unavailable\n");
+    }
+}
+#endif
+
 int main() {
     // Allocate the test vectors
     printf("Allocating vectors\n");
@@ -72,5 +152,57 @@ int main() {
 
     printf("Speed: %lf MDotProd/s\n", avg / (double)TEST_COUNT);
 
+    // Write a text matrix to parse
+    printf("Writing text matrix\n");
+    lia::DMatd text(TEXT_LINES, TEXT_COLUMNS);
+    for (int i = 0; i < TEXT_LINES*TEXT_COLUMNS; i++) {
+        text[i] = ((double)rand() / (double)RAND_MAX - 0.5) * 1e6;
+    }
+    lia::saveText("lia_demo_text.csv", text);
+
+    // Read it back into memory for the strtod baseline
+    FILE* fp = fopen("lia_demo_text.csv", "rb");
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char* buf = new char[size + 1];
+    fread(buf, 1, size, fp);
+    buf[size] = 0;
+    fclose(fp);
+    double megabytes = (double)size / 1e6;
+
+    double textAvg = 0.0;
+    double strtodAvg = 0.0;
+    for (int i = 0; i < TEXT_RUNS; i++) {
+        printf("Benchmarking text parsing\n");
+        auto begin = std::chrono::high_resolution_clock::now();
+        lia::DMatd loaded = lia::loadText<double>("lia_demo_text.csv");
+        auto end = std::chrono::high_resolution_clock::now();
+        textAvg += megabytes / ((end - begin).count() / 1e9);
+
+        // Parse the same text with strtod, skipping the delimiters and newlines
+        begin = std::chrono::high_resolution_clock::now();
+        const char* p = buf;
+        double* r = text.data();
+        while (*p) {
+            char* next;
+            *(r++) = strtod(p, &next);
+            p = *next ? next + 1 : next;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        strtodAvg += megabytes / ((end - begin).count() / 1e9);
+    }
+    delete[] buf;
+    remove("lia_demo_text.csv");
+
+    printf("Text: %lf MB/s (strtod: %lf MB/s)\n", textAvg / (double)TEXT_RUNS, strtodAvg / (double)TEXT_RUNS);
+
+#ifdef __linux__
+    // Compare regular pages against transparent huge pages on a product larger than the TLB reach
+    printf("Benchmarking huge pages\n");
+    benchTLB(lia::ALLOC_HEAP, "4K pages");
+    benchTLB(lia::ALLOC_TRANSPARENT_HUGE_PAGES, "Huge pages");
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "async.h"
+#include "thread_pool.h"
+
+namespace lia::async {
+    // Worker running on the calling thread
+    static thread_local _Worker* _current = nullptr;
+
+    _Worker::_Worker() {
+        _thread = std::thread(&_Worker::loop, this);
+    }
+
+    _Worker::~_Worker() {
+        // Tell the thread to stop once the queue is empty
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            _stop = true;
+        }
+        _cnd.notify_all();
+        _thread.join();
+    }
+
+    void _Worker::post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (!_exited) {
+                _queue.push_back(std::move(task));
+                _cnd.notify_all();
+                return;
+            }
+        }
+
+        // The thread has exited during shutdown, run the task on the caller
+        task();
+    }
+
+    void _Worker::runUntil(const std::function<bool()>& done) {
+        std::unique_lock<std::mutex> lck(_mtx);
+        while (true) {
+            // Wait for the condition or for a task
+            _cnd.wait(lck, [&]() { return done() || !_queue.empty(); });
+            if (done()) { return; }
+            std::function<void()> task = std::move(_queue.front());
+            _queue.pop_front();
+
+            // Run the task nested in the waiting one
+            lck.unlock();
+            task();
+            lck.lock();
+        }
+    }
+
+    void _Worker::wake() {
+        // Taking the lock makes sure the waiting thread is either before its check or already waiting
+        std::lock_guard<std::mutex> lck(_mtx);
+        _cnd.notify_all();
+    }
+
+    _Worker* _Worker::current() {
+        return _current;
+    }
+
+    void _Worker::loop() {
+        _current = this;
+        std::unique_lock<std::mutex> lck(_mtx);
+        while (true) {
+            // Wait for a task or for the stop signal
+            _cnd.wait(lck, [this]() { return _stop || !_queue.empty(); });
+            if (_queue.empty()) {
+                _exited = true;
+                return;
+            }
+            std::function<void()> task = std::move(_queue.front());
+            _queue.pop_front();
+
+            // Tasks complete their future themselves, including on failure
+            lck.unlock();
+            task();
+            lck.lock();
+        }
+    }
+
+    Executor::Executor() {
+        // Create the global pool first so that it outlives the tasks still queued when the executor is destroyed
+        ThreadPool::global();
+    }
+
+    void Executor::submit(std::function<void()> task) {
+        _dispatcher.post(std::move(task));
+    }
+
+    void Executor::resume(std::coroutine_handle<> handle) {
+        _resumer.post([handle]() { handle.resume(); });
+    }
+
+    Executor& Executor::global() {
+        static Executor executor;
+        return executor;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,377 @@
+#pragma once
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <tuple>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include "dense/dynamic.h"
+
+namespace lia::async {
+    // Thread running queued tasks one at a time, the executor uses one for kernels and one to resume coroutines
+    class _Worker {
+    public:
+        // Create a worker and start its thread
+        _Worker();
+
+        // Workers can't be copied
+        _Worker(const _Worker& copy) = delete;
+
+        // Destructor, runs the remaining tasks before returning
+        ~_Worker();
+
+        // Queue a task, runs it on the caller instead if the thread has already exited during shutdown
+        void post(std::function<void()> task);
+
+        // Run queued tasks on the calling worker thread until a condition holds
+        void runUntil(const std::function<bool()>& done);
+
+        // Wake the thread so that runUntil checks its condition again
+        void wake();
+
+        // Get the worker running on the calling thread, null if it isn't a worker thread
+        static _Worker* current();
+
+    private:
+        // Worker thread loop
+        void loop();
+
+        // Worker thread
+        std::thread _thread;
+
+        // Protects the queue
+        std::mutex _mtx;
+        std::condition_variable _cnd;
+
+        // Tasks waiting to run
+        std::deque<std::function<void()>> _queue;
+
+        // Set when the thread must exit once the queue is empty, and once it has
+        bool _stop = false;
+        bool _exited = false;
+    };
+
+    /**
+     * Executor of the asynchronous kernels. Kernels run one at a time on a dispatcher thread, each splitting its work
+     * across the global thread pool as usual, so asynchronous work never runs more threads than the pool has, and
+     * kernels called synchronously while it is busy run inline on their caller. Coroutines are resumed on a second
+     * thread so that they can block on other futures without stopping the dispatcher.
+    */
+    class Executor {
+    public:
+        // Create an executor and start its threads
+        Executor();
+
+        // Executors can't be copied
+        Executor(const Executor& copy) = delete;
+
+        /**
+         * Queue a kernel, kernels run in submission order.
+         * @param task Task to run on the dispatcher thread.
+        */
+        void submit(std::function<void()> task);
+
+        /**
+         * Queue the resumption of a suspended coroutine.
+         * @param handle Coroutine to resume on the resume thread.
+        */
+        void resume(std::coroutine_handle<> handle);
+
+        /**
+         * Get the executor shared by all asynchronous kernels.
+         * @return Global executor.
+        */
+        static Executor& global();
+
+    private:
+        // Declared first to be destroyed last, kernels finishing during shutdown may still resume coroutines
+        _Worker _resumer;
+
+        // Runs the kernels
+        _Worker _dispatcher;
+    };
+
+    // Shared completion state of a future
+    template <typename T>
+    class _State {
+    public:
+        // Register a callback to run on completion, returns false without registering it if already complete
+        bool defer(std::function<void()> callback) {
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (_done) { return false; }
+            _callbacks.push_back(std::move(callback));
+            return true;
+        }
+
+        // Register a callback to run on completion, runs it immediately if already complete
+        void onDone(std::function<void()> callback) {
+            if (!defer(callback)) { callback(); }
+        }
+
+        // Complete with a value, or nothing for void states
+        template <typename... V>
+        void complete(V&&... value) {
+            std::unique_lock<std::mutex> lck(_mtx);
+            _value.emplace(std::forward<V>(value)...);
+            finish(lck);
+        }
+
+        // Complete with an error
+        void fail(std::exception_ptr error) {
+            std::unique_lock<std::mutex> lck(_mtx);
+            _error = error;
+            finish(lck);
+        }
+
+        // Wait for completion. Executor threads keep running their queue meanwhile, it may hold the task completing
+        // the state
+        void wait() {
+            _Worker* worker = _Worker::current();
+            if (worker && defer([worker]() { worker->wake(); })) {
+                worker->runUntil([this]() { return ready(); });
+                return;
+            }
+            std::unique_lock<std::mutex> lck(_mtx);
+            _cnd.wait(lck, [this]() { return _done; });
+        }
+
+        // Check for completion without waiting
+        bool ready() {
+            std::lock_guard<std::mutex> lck(_mtx);
+            return _done;
+        }
+
+        // Get the error of a complete state, null on success
+        std::exception_ptr error() {
+            std::lock_guard<std::mutex> lck(_mtx);
+            return _error;
+        }
+
+        // Wait for completion and return the value, rethrowing the error on failure
+        T get() {
+            wait();
+            if (_error) { std::rethrow_exception(_error); }
+            if constexpr (!std::is_void_v<T>) { return *_value; }
+        }
+
+    private:
+        // Mark as complete and run the callbacks outside of the lock
+        void finish(std::unique_lock<std::mutex>& lck) {
+            _done = true;
+            std::vector<std::function<void()>> callbacks;
+            callbacks.swap(_callbacks);
+            lck.unlock();
+            _cnd.notify_all();
+            for (auto& cb : callbacks) { cb(); }
+        }
+
+        std::mutex _mtx;
+        std::condition_variable _cnd;
+        bool _done = false;
+        std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> _value;
+        std::exception_ptr _error;
+        std::vector<std::function<void()>> _callbacks;
+    };
+
+    template <typename T>
+    struct _Promise;
+
+    /**
+     * Result of an asynchronous kernel or coroutine. Futures can be awaited with co_await, waited for with get, and
+     * chained with then and whenAll to build task graphs. Coroutines returning a future start immediately and run
+     * until their first suspension on the calling thread, they are then resumed on the resume thread of the executor
+     * where they may block on other futures.
+    */
+    template <typename T = void>
+    class Future {
+    public:
+        // Coroutine promise of coroutines returning a future
+        using promise_type = _Promise<T>;
+
+        // Create a future from its shared state
+        Future(std::shared_ptr<_State<T>> state) : _state(std::move(state)) {}
+
+        /**
+         * Check if the result is available without waiting.
+         * @return True if the kernel or coroutine has finished.
+        */
+        bool ready() const { return _state->ready(); }
+
+        // Wait for the kernel or coroutine to finish
+        void wait() const { _state->wait(); }
+
+        /**
+         * Wait for the result. Rethrows the exception thrown by the kernel or coroutine if it failed.
+         * @return Result of the kernel or coroutine.
+        */
+        T get() const { return _state->get(); }
+
+        /**
+         * Run a kernel on the executor once this future has finished. The kernel is skipped and the returned future
+         * fails with the same exception if this one fails.
+         * @param kernel Function taking no arguments.
+         * @return Future of the result of the kernel.
+        */
+        template <class F>
+        auto then(F kernel) const;
+
+        // Awaiter interface, the awaiting coroutine is resumed on the resume thread once the future completes
+        bool await_ready() const { return _state->ready(); }
+        bool await_suspend(std::coroutine_handle<> handle) const {
+            return _state->defer([handle]() { Executor::global().resume(handle); });
+        }
+        T await_resume() const { return _state->get(); }
+
+        // Shared state, also used by then and whenAll to register their dependencies
+        std::shared_ptr<_State<T>> _state;
+    };
+
+    // Promise parts common to all result types, the coroutine starts eagerly and its frame is freed when it returns
+    template <typename T>
+    struct _PromiseBase {
+        Future<T> get_return_object() { return Future<T>(state); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void unhandled_exception() { state->fail(std::current_exception()); }
+
+        std::shared_ptr<_State<T>> state = std::make_shared<_State<T>>();
+    };
+
+    template <typename T>
+    struct _Promise : _PromiseBase<T> {
+        void return_value(T value) { this->state->complete(std::move(value)); }
+    };
+
+    template <>
+    struct _Promise<void> : _PromiseBase<void> {
+        void return_void() { this->state->complete(); }
+    };
+
+    // Run a kernel on the executor and complete a state with its result
+    template <typename R, class F>
+    static void _dispatch(const std::shared_ptr<_State<R>>& state, F kernel) {
+        Executor::global().submit([state, kernel]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    kernel();
+                    state->complete();
+                }
+                else {
+                    state->complete(kernel());
+                }
+            }
+            catch (...) {
+                state->fail(std::current_exception());
+            }
+        });
+    }
+
+    /**
+     * Run a kernel asynchronously on the executor.
+     * @param kernel Function taking no arguments.
+     * @return Future of the result of the kernel.
+    */
+    template <class F>
+    static Future<std::invoke_result_t<F&>> run(F kernel) {
+        using R = std::invoke_result_t<F&>;
+        auto state = std::make_shared<_State<R>>();
+        _dispatch(state, std::move(kernel));
+        return Future<R>(state);
+    }
+
+    template <typename T>
+    template <class F>
+    auto Future<T>::then(F kernel) const {
+        using R = std::invoke_result_t<F&>;
+        auto state = std::make_shared<_State<R>>();
+        auto dep = _state;
+        dep->onDone([state, dep, kernel]() {
+            std::exception_ptr err = dep->error();
+            if (err) {
+                state->fail(err);
+                return;
+            }
+            _dispatch(state, kernel);
+        });
+        return Future<R>(state);
+    }
+
+    /**
+     * Get a future that finishes once all the given futures have finished, failing with the first exception
+     * encountered if any of them fails.
+     * @param futures Futures to wait for.
+     * @return Future finishing after all of them.
+    */
+    template <typename... Ts>
+    static Future<void> whenAll(const Future<Ts>&... futures) {
+        // One count per future plus one released after registering, so that the state can't complete early
+        struct Join {
+            std::mutex mtx;
+            int pending;
+            std::exception_ptr error;
+        };
+        auto state = std::make_shared<_State<void>>();
+        auto join = std::make_shared<Join>();
+        join->pending = (int)sizeof...(Ts) + 1;
+        auto release = [state, join](std::exception_ptr err) {
+            std::unique_lock<std::mutex> lck(join->mtx);
+            if (err && !join->error) { join->error = err; }
+            if (--join->pending) { return; }
+            lck.unlock();
+            if (join->error) { state->fail(join->error); }
+            else { state->complete(); }
+        };
+        (futures._state->onDone([release, dep = futures._state]() { release(dep->error()); }), ...);
+        release(nullptr);
+        return Future<void>(state);
+    }
+
+    // Bind the arguments of a kernel, lvalues by reference and temporaries by value
+    template <class F, typename... Args>
+    static auto _bind(F f, Args&&... args) {
+        return [f, args = std::tuple<Args...>(std::forward<Args>(args)...)]() mutable { return std::apply(f, args); };
+    }
+
+    // ========================== ASYNCHRONOUS KERNELS ==========================
+    // Asynchronous versions of the dynamic kernels taking the same arguments. Matrices and output scalars are
+    // captured by reference and must stay alive and untouched until the future finishes, temporaries are copied.
+
+    template <typename... Args>
+    static Future<void> dot(Args&&... args) { return run(_bind([](auto&... a) { lia::dot(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> tdot(Args&&... args) { return run(_bind([](auto&... a) { lia::tdot(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> gemv(Args&&... args) { return run(_bind([](auto&... a) { lia::gemv(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> add(Args&&... args) { return run(_bind([](auto&... a) { lia::add(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> sub(Args&&... args) { return run(_bind([](auto&... a) { lia::sub(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> mul(Args&&... args) { return run(_bind([](auto&... a) { lia::mul(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> div(Args&&... args) { return run(_bind([](auto&... a) { lia::div(a...); }, std::forward<Args>(args)...)); }
+
+    template <typename... Args>
+    static Future<void> transpose(Args&&... args) { return run(_bind([](auto&... a) { lia::transpose(a...); }, std::forward<Args>(args)...)); }
+
+    /**
+     * Compute the euclidian norm of a vector asynchronously.
+     * @param value Vector to take the euclidian norm of, must stay alive until the future finishes.
+     * @return Future of the norm.
+    */
+    template <typename T>
+    static Future<T> norm(const DVec<T>& value) { return run([&value]() { return lia::norm(value); }); }
+}
\ No newline at end of file
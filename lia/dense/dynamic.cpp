@@ -1,48 +1,383 @@
 #include "dynamic.h"
+#include "../thread_pool.h"
+#include "../numa.h"
 #include <type_traits>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <vector>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 namespace lia {
+    // Minimum amount of work (in elements or multiply-adds) before a kernel is split across threads
+    #define LIA_PARALLEL_MIN_WORK   (1 << 16)
+
+    // Run a kernel over the lines of a matrix, split into one contiguous block of lines per thread of the global pool.
+    // First-touch allocation uses the same split so that each thread processes lines stored on its own NUMA node.
+    template <class F>
+    static LIA_FORCE_INLINE void _parallelLines(int ls, int64_t work, F task) {
+        ThreadPool& pool = ThreadPool::global();
+        const int chunks = pool.threads();
+        if (work < LIA_PARALLEL_MIN_WORK || chunks == 1 || ls < 2) {
+            task(0, ls);
+            return;
+        }
+        pool.run(chunks, [&](int id) {
+            int begin, end;
+            partition(ls, chunks, id, begin, end);
+            if (begin < end) { task(begin, end); }
+        });
+    }
+
+    // Number of elements of the fixed blocks of the reproducible reductions, changing it changes the rounding
+#ifndef LIA_REDUCE_BLOCK
+    #define LIA_REDUCE_BLOCK    4096
+#endif
+
+    // Sum partial results with a fixed pairwise tree
+    template <typename T>
+    static T _pairwise(const T* partials, int count) {
+        if (count == 1) { return partials[0]; }
+        const int half = count / 2;
+        return _pairwise(partials, half) + _pairwise(&partials[half], count - half);
+    }
+
+    // Reduce a range of elements by summing the results of a block kernel over sub-ranges. The fast mode uses one
+    // sub-range per thread, the reproducible mode fixed blocks whose results are summed in the same order for any
+    // number of threads.
+    template <typename T, class F>
+    static LIA_FORCE_INLINE T _reduce(int count, ReduceMode mode, F block) {
+        if (count <= 0) { return (T)0; }
+        if (mode == REDUCE_REPRODUCIBLE) {
+            const int blocks = (count + LIA_REDUCE_BLOCK - 1) / LIA_REDUCE_BLOCK;
+            if (blocks == 1) { return block(0, count); }
+            std::vector<T> partials(blocks);
+            T* p = partials.data();
+            _parallelLines(blocks, count, [=](int begin, int end) {
+                for (int i = begin; i < end; i++) {
+                    p[i] = block(i*LIA_REDUCE_BLOCK, std::min<int>(count, (i + 1)*LIA_REDUCE_BLOCK));
+                }
+            });
+            return _pairwise(p, blocks);
+        }
+
+        ThreadPool& pool = ThreadPool::global();
+        const int chunks = pool.threads();
+        if (count < LIA_PARALLEL_MIN_WORK || chunks == 1) { return block(0, count); }
+        std::vector<T> partials(chunks, (T)0);
+        pool.run(chunks, [&](int id) {
+            int begin, end;
+            partition(count, chunks, id, begin, end);
+            if (begin < end) { partials[id] = block(begin, end); }
+        });
+        T sum = (T)0;
+        for (int i = 0; i < chunks; i++) { sum += partials[i]; }
+        return sum;
+    }
+
+    // Dot product of two ranges with eight independent accumulators summed in a fixed order
+    template <typename T>
+    static LIA_FORCE_INLINE T _dotRange(const T* a, const T* b, int count) {
+        T acc[8] = {};
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            for (int k = 0; k < 8; k++) { acc[k] += a[i + k]*b[i + k]; }
+        }
+        for (int k = 0; i < count; i++, k++) { acc[k] += a[i]*b[i]; }
+        return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    }
+
+    // Size of a huge page
+    #define LIA_HUGE_PAGE_SIZE  ((size_t)2 << 20)
+
+    // Size from which the default policy uses transparent huge pages
+#ifndef LIA_HUGE_PAGE_THRESHOLD
+    #define LIA_HUGE_PAGE_THRESHOLD ((size_t)4 << 20)
+#endif
+
+#ifdef __linux__
+    // Map anonymous memory aligned to a huge page, the size must be a multiple of the huge page size
+    static void* _mapAligned(size_t size) {
+        // Over-allocate by a huge page and trim the unaligned head and the tail
+        uint8_t* base = (uint8_t*)mmap(NULL, size + LIA_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == (uint8_t*)MAP_FAILED) { return NULL; }
+        uint8_t* aligned = (uint8_t*)(((uintptr_t)base + LIA_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(LIA_HUGE_PAGE_SIZE - 1));
+        if (aligned > base) { munmap(base, aligned - base); }
+        if (aligned + size < base + size + LIA_HUGE_PAGE_SIZE) { munmap(aligned + size, (base + size + LIA_HUGE_PAGE_SIZE) - (aligned + size)); }
+        return aligned;
+    }
+#endif
+
+    // Get the size actually mapped for a buffer allocated with a given (resolved) policy
+    static LIA_FORCE_INLINE size_t _mappedSize(size_t size, Alloc alloc) {
+        if (alloc == ALLOC_TRANSPARENT_HUGE_PAGES || alloc == ALLOC_HUGE_PAGES || size >= LIA_HUGE_PAGE_THRESHOLD) {
+            return (size + LIA_HUGE_PAGE_SIZE - 1) & ~(LIA_HUGE_PAGE_SIZE - 1);
+        }
+        return size;
+    }
+
+    // Allocate a data buffer, falling back and updating the policy if the requested one isn't supported
+    template <typename DT>
+    static DT* _allocate(int ls, int cs, Alloc& alloc) {
+        const size_t size = (size_t)ls * (size_t)cs * sizeof(DT);
+        if (alloc == ALLOC_DEFAULT) {
+            alloc = (size >= LIA_HUGE_PAGE_THRESHOLD) ? ALLOC_TRANSPARENT_HUGE_PAGES : ALLOC_HEAP;
+        }
+#ifdef __linux__
+        if (alloc != ALLOC_HEAP && size) {
+            const size_t msize = _mappedSize(size, alloc);
+            DT* buf = NULL;
+
+            // Try explicit huge pages first if requested
+#ifdef MAP_HUGETLB
+            if (alloc == ALLOC_HUGE_PAGES) {
+                buf = (DT*)mmap(NULL, msize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (buf == (DT*)MAP_FAILED) { buf = NULL; }
+            }
+#endif
+            if (alloc == ALLOC_HUGE_PAGES && !buf) { alloc = ALLOC_TRANSPARENT_HUGE_PAGES; }
+
+            // Otherwise map regular pages, huge page aligned when large enough
+            if (!buf) {
+                buf = (msize != size) ? (DT*)_mapAligned(msize) : (DT*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (buf == (DT*)MAP_FAILED) { buf = NULL; }
+#ifdef MADV_HUGEPAGE
+                if (buf && msize != size) { madvise(buf, msize, MADV_HUGEPAGE); }
+#endif
+            }
+
+            // Touch the pages from the pinned workers that will process them. If the touch can't run on the workers,
+            // such as from inside a task, while the pool is busy or on a single node machine, interleave instead
+            if (buf && alloc == ALLOC_NUMA_FIRST_TOUCH) {
+                ThreadPool& pool = ThreadPool::global();
+                const int chunks = pool.threads();
+                const bool touched = numaNodes() > 1 && pool.pin() && pool.tryRun(chunks, [=](int id) {
+                    int begin, end;
+                    partition(ls, chunks, id, begin, end);
+                    memset(&buf[(size_t)begin*cs], 0, (size_t)(end - begin)*cs*sizeof(DT));
+                });
+                if (!touched) { alloc = ALLOC_NUMA_INTERLEAVE; }
+            }
+
+            // Interleave the pages before they get faulted in. If that isn't supported, report the plain mapping
+            // as transparent huge pages when large enough for them to map the same size, or use the heap otherwise
+            if (buf && alloc == ALLOC_NUMA_INTERLEAVE && !numaInterleave(buf, msize)) {
+                if (size >= LIA_HUGE_PAGE_THRESHOLD) {
+                    alloc = ALLOC_TRANSPARENT_HUGE_PAGES;
+                }
+                else {
+                    munmap(buf, msize);
+                    buf = NULL;
+                }
+            }
+
+            if (buf) { return buf; }
+        }
+#endif
+        alloc = ALLOC_HEAP;
+        return new DT[ls*cs];
+    }
+
+    // Free a data buffer allocated with a given (resolved) policy
+    template <typename DT>
+    static void _free(DT* data, int elements, Alloc alloc) {
+        if (alloc == ALLOC_INLINE) { return; }
+#ifdef __linux__
+        if (alloc != ALLOC_HEAP) {
+            munmap(data, _mappedSize((size_t)elements * sizeof(DT), alloc));
+            return;
+        }
+#endif
+        delete[] data;
+    }
+
     template <typename DT>
     DMat<DT>::DMat() : ls(0), cs(0) {
         // Null out the buffer pointer
         _data = NULL;
+        _capacity = 0;
+        _owned = false;
+        _request = ALLOC_DEFAULT;
+        _alloc = ALLOC_HEAP;
+        _layout = LAYOUT_ROW_MAJOR;
     }
 
     template <typename DT>
-    DMat<DT>::DMat(int lines, int columns) : ls(lines), cs(columns) {
+    DMat<DT>::DMat(int lines, int columns) : DMat(lines, columns, LAYOUT_ROW_MAJOR, ALLOC_DEFAULT) {}
+
+    template <typename DT>
+    DMat<DT>::DMat(int lines, int columns, Alloc alloc) : DMat(lines, columns, LAYOUT_ROW_MAJOR, alloc) {}
+
+    template <typename DT>
+    DMat<DT>::DMat(int lines, int columns, Layout layout, Alloc alloc) : ls(lines), cs(columns) {
         // Allocate the data buffer
-        _data = new DT[ls*cs];
+        _request = alloc;
+        _alloc = _request;
+        _layout = layout;
+        _data = acquire(ls, cs, _alloc, _capacity);
+        _owned = true;
+    }
+
+    template <typename DT>
+    DMat<DT>::DMat(int lines, int columns, DT* buffer) : DMat(lines, columns, buffer, LAYOUT_ROW_MAJOR) {}
+
+    template <typename DT>
+    DMat<DT>::DMat(int lines, int columns, DT* buffer, Layout layout) : ls(lines), cs(columns) {
+        // Reference the external buffer
+        _data = buffer;
+        _capacity = ls*cs;
+        _owned = false;
+        _request = ALLOC_DEFAULT;
+        _alloc = ALLOC_HEAP;
+        _layout = layout;
     }
 
     template <typename DT>
     DMat<DT>::DMat(const DMat& copy) : ls(copy.ls), cs(copy.cs) {
-        // Allocate the data buffer
-        _data = new DT[ls*cs];
+        // Allocate the data buffer with the same policy
+        _request = copy._request;
+        _alloc = copy._alloc;
+        _layout = copy._layout;
+        _data = acquire(ls, cs, _alloc, _capacity);
+        _owned = true;
 
         // Copy over the data
         memcpy(_data, copy._data, ls*cs*sizeof(DT));
     }
 
     template <typename DT>
-    DMat<DT>::DMat(DMat&& move) : ls(move.ls), cs(move.cs) {
-        // Copy the data buffer pointer
-        _data = move._data;
+    DMat<DT>::DMat(DMat&& move) noexcept : ls(move.ls), cs(move.cs) {
+        // Copy the data buffer pointer, inline data has to be copied instead
+        _data = (move._alloc == ALLOC_INLINE) ? _inline : move._data;
+        _capacity = move._capacity;
+        _owned = move._owned;
+        _request = move._request;
+        _alloc = move._alloc;
+        _layout = move._layout;
+        if (_alloc == ALLOC_INLINE) { memcpy(_inline, move._inline, ls*cs*sizeof(DT)); }
 
         // Prevent the moved object from deleting the buffer
         move._data = NULL;
+        move._capacity = 0;
+        move._owned = false;
+        move._alloc = ALLOC_HEAP;
+        move.ls = 0;
+        move.cs = 0;
     }
 
     template <typename DT>
     DMat<DT>::~DMat() {
         // Free the data buffer if it was allocated
-        if (_data) { delete[] _data; }
+        if (_data && _owned) { _free(_data, _capacity, _alloc); }
+    }
+
+    template <typename DT>
+    DMat<DT>& DMat<DT>::operator=(const DMat& copy) {
+        if (this == &copy) { return *this; }
+
+        // Reallocate only if the buffer is too small, then copy over the data
+        resize(copy.ls, copy.cs);
+        _layout = copy._layout;
+        memcpy(_data, copy._data, ls*cs*sizeof(DT));
+        return *this;
+    }
+
+    template <typename DT>
+    DMat<DT>& DMat<DT>::operator=(DMat&& move) noexcept {
+        if (this == &move) { return *this; }
+
+        // Free the current buffer and take over the other one, inline data has to be copied instead
+        if (_data && _owned) { _free(_data, _capacity, _alloc); }
+        ls = move.ls;
+        cs = move.cs;
+        _data = (move._alloc == ALLOC_INLINE) ? _inline : move._data;
+        _capacity = move._capacity;
+        _owned = move._owned;
+        _request = move._request;
+        _alloc = move._alloc;
+        _layout = move._layout;
+        if (_alloc == ALLOC_INLINE) { memcpy(_inline, move._inline, ls*cs*sizeof(DT)); }
+
+        // Prevent the moved object from deleting the buffer
+        move._data = NULL;
+        move._capacity = 0;
+        move._owned = false;
+        move._alloc = ALLOC_HEAP;
+        move.ls = 0;
+        move.cs = 0;
+        return *this;
+    }
+
+    template <typename DT>
+    DT* DMat<DT>::acquire(int lines, int columns, Alloc& alloc, int& capacity) {
+        const int elements = lines*columns;
+
+        // Use the inline buffer if the matrix is small enough
+        if (alloc == ALLOC_DEFAULT || alloc == ALLOC_HEAP || alloc == ALLOC_INLINE) {
+            if (elements <= LIA_DMAT_INLINE_SIZE) {
+                alloc = ALLOC_INLINE;
+                capacity = LIA_DMAT_INLINE_SIZE;
+                return _inline;
+            }
+            if (alloc == ALLOC_INLINE) { alloc = ALLOC_DEFAULT; }
+        }
+
+        // Otherwise allocate it, only reporting the capacity once the buffer was obtained
+        DT* data = _allocate<DT>(lines, columns, alloc);
+        capacity = elements;
+        return data;
+    }
+
+    template <typename DT>
+    void DMat<DT>::realloc(int lines, int columns, bool keep) {
+        // Get the new buffer with the requested policy
+        Alloc alloc = _request;
+        int capacity;
+        DT* data = acquire(lines, columns, alloc, capacity);
+
+        // Copy over the elements and free the old buffer
+        if (keep && _data) { memcpy(data, _data, ls*cs*sizeof(DT)); }
+        if (_data && _owned) { _free(_data, _capacity, _alloc); }
+
+        // Use the new buffer
+        _data = data;
+        _capacity = capacity;
+        _owned = true;
+        _alloc = alloc;
+    }
+
+    template <typename DT>
+    void DMat<DT>::resize(int lines, int columns) {
+        if (lines*columns > _capacity) { realloc(lines, columns, true); }
+        ls = lines;
+        cs = columns;
+    }
+
+    template <typename DT>
+    void DMat<DT>::reshape(int lines, int columns) {
+        if (lines*columns != ls*cs) { throw std::invalid_argument("Reshaping must keep the number of elements"); }
+        ls = lines;
+        cs = columns;
+    }
+
+    template <typename DT>
+    void DMat<DT>::reserve(int elements) {
+        if (elements > _capacity) { realloc(elements, 1, true); }
     }
 
     template class DMat<double>;
     template class DMat<float>;
     template class DMat<int>;
+    template class DMat<int8_t>;
 
     template <typename DT>
     DVec<DT>::DVec() {}
@@ -50,9 +385,46 @@ namespace lia {
     template <typename DT>
     DVec<DT>::DVec(int lines) : DMat<DT>(lines, 1) {}
 
+    template <typename DT>
+    DVec<DT>::DVec(int lines, DT* buffer) : DMat<DT>(lines, 1, buffer) {}
+
     template class DVec<double>;
     template class DVec<float>;
     template class DVec<int>;
+    template class DVec<int8_t>;
+
+    QParams::QParams(float scale, int zero) {
+        // Save the per-tensor parameters
+        _scale = scale;
+        _zero = zero;
+        _scales = NULL;
+        _zeros = NULL;
+    }
+
+    QParams::QParams(const DVec<float>& scales, const DVec<int>& zeros) {
+        // Reference the per-line or per-column parameters
+        _scale = 1.0f;
+        _zero = 0;
+        _scales = scales.data();
+        _zeros = zeros.data();
+    }
+
+    // Fill a matrix element by element when its operands have a different layout, going through it in storage order
+    template <typename T, class F>
+    static void _elementwise(DMat<T>& result, F op) {
+        const int ls = result.ls;
+        const int cs = result.cs;
+        if (result.layout() == LAYOUT_ROW_MAJOR) {
+            for (int i = 0; i < ls; i++) {
+                for (int j = 0; j < cs; j++) { result(i, j) = op(i, j); }
+            }
+        }
+        else {
+            for (int j = 0; j < cs; j++) {
+                for (int i = 0; i < ls; i++) { result(i, j) = op(i, j); }
+            }
+        }
+    }
 
     template <typename TA, typename TB>
     void cast(DVec<TB>& result, const DVec<TA>& value) {
@@ -66,12 +438,16 @@ namespace lia {
     template void cast(DVec<float>& result, const DVec<double>& value);
     template void cast(DVec<int>& result, const DVec<double>& value);
     template void cast(DVec<double>& result, const DVec<float>& value);
-    template void cast(DVec<int>& result, const DVec<double>& value);
+    template void cast(DVec<int>& result, const DVec<float>& value);
     template void cast(DVec<double>& result, const DVec<int>& value);
     template void cast(DVec<float>& result, const DVec<int>& value);
 
     template <typename TA, typename TB>
     void cast(DMat<TB>& result, const DMat<TA>& value) {
+        if (result.layout() != value.layout()) {
+            _elementwise(result, [&](int i, int j) { return (TB)value(i, j); });
+            return;
+        }
         const TA* a = value.data();
         TB* r = result.data();
         const int d = value.ls * value.cs;
@@ -82,17 +458,18 @@ namespace lia {
     template void cast(DMat<float>& result, const DMat<double>& value);
     template void cast(DMat<int>& result, const DMat<double>& value);
     template void cast(DMat<double>& result, const DMat<float>& value);
-    template void cast(DMat<int>& result, const DMat<double>& value);
+    template void cast(DMat<int>& result, const DMat<float>& value);
     template void cast(DMat<double>& result, const DMat<int>& value);
     template void cast(DMat<float>& result, const DMat<int>& value);
 
     template <typename T>
     void clear(DVec<T>& result, T value) {
         T* r = result.data();
-        const int d = result.ls;
-        for (int i = 0; i < d; i++) {
-            r[i] = value;
-        }
+        _parallelLines(result.ls, result.ls, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                r[i] = value;
+            }
+        });
     }
     template void clear(DVec<double>& result, double value);
     template void clear(DVec<float>& result, float value);
@@ -101,10 +478,12 @@ namespace lia {
     template <typename T>
     void clear(DMat<T>& result, T value) {
         T* r = result.data();
-        const int d = result.ls*result.cs;
-        for (int i = 0; i < d; i++) {
-            r[i] = value;
-        }
+        const int cs = result.cs;
+        _parallelLines(result.ls, (int64_t)result.ls*cs, [=](int begin, int end) {
+            for (int i = begin*cs; i < end*cs; i++) {
+                r[i] = value;
+            }
+        });
     }
     template void clear(DMat<double>& result, double value);
     template void clear(DMat<float>& result, float value);
@@ -129,10 +508,18 @@ namespace lia {
 
     template <typename T>
     void transpose(DMat<T>& result, const DMat<T>& value) {
+        // With opposite layouts the transpose is stored exactly like the value
+        if (result.layout() != value.layout()) {
+            memcpy(result.data(), value.data(), (size_t)value.ls*value.cs*sizeof(T));
+            return;
+        }
+
+        // Otherwise transpose the buffers, column-major ones being the row-major storage of their own transpose
         const T* v = value.data();
         T* r = result.data();
-        const int ls = value.ls;
-        const int cs = value.cs;
+        const bool rowMajor = (value.layout() == LAYOUT_ROW_MAJOR);
+        const int ls = rowMajor ? value.ls : value.cs;
+        const int cs = rowMajor ? value.cs : value.ls;
         for (int i = 0; i < ls; i++) {
             const T* line = &v[i*cs];
             for (int j = 0; j < cs; j++) {
@@ -146,22 +533,77 @@ namespace lia {
 
     template <typename T>
     T norm(const DVec<T>& value) {
+        return norm(value, REDUCE_FAST);
+    }
+    template double norm<double>(const DVec<double>& value);
+    template float norm<float>(const DVec<float>& value);
+    template int norm<int>(const DVec<int>& value);
+
+    template <typename T>
+    T norm(const DVec<T>& value, ReduceMode mode) {
         const T* v = value.data();
+        const T sum = _reduce<T>(value.ls, mode, [=](int begin, int end) { return _dotRange(&v[begin], &v[begin], end - begin); });
+        if constexpr (std::is_same_v<T, float>) {
+            return sqrtf(sum);
+        }
+        else {
+            return (T)sqrt(sum);
+        }
+    }
+    template double norm<double>(const DVec<double>& value, ReduceMode mode);
+    template float norm<float>(const DVec<float>& value, ReduceMode mode);
+    template int norm<int>(const DVec<int>& value, ReduceMode mode);
+
+    template <typename T>
+    void normalize(DVec<T>& result, const DVec<T>& value) {
+        const T* v = value.data();
+        T* r = result.data();
         const int ls = value.ls;
         T sum = (T)0.0;
         for (int i = 0; i < ls; i++) {
             sum += v[i]*v[i];
         }
+        T inv;
         if constexpr (std::is_same_v<T, float>) {
-            return sqrtf(sum);
+            inv = 1.0f / sqrtf(sum);
         }
         else {
-            return (T)sqrt(sum);
+            inv = (T)1.0 / (T)sqrt(sum);
+        }
+        for (int i = 0; i < ls; i++) {
+            r[i] = v[i]*inv;
         }
     }
-    template double norm<double>(const DVec<double>& value);
-    template float norm<float>(const DVec<float>& value);
-    template int norm<int>(const DVec<int>& value);
+    template void normalize(DVec<double>& result, const DVec<double>& value);
+    template void normalize(DVec<float>& result, const DVec<float>& value);
+
+    template <typename T>
+    T distance2(const DVec<T>& left, const DVec<T>& right) {
+        const T* a = left.data();
+        const T* b = right.data();
+        const int ls = left.ls;
+        T sum = (T)0.0;
+        for (int i = 0; i < ls; i++) {
+            sum += (a[i] - b[i])*(a[i] - b[i]);
+        }
+        return sum;
+    }
+    template double distance2<double>(const DVec<double>& left, const DVec<double>& right);
+    template float distance2<float>(const DVec<float>& left, const DVec<float>& right);
+    template int distance2<int>(const DVec<int>& left, const DVec<int>& right);
+
+    template <typename T>
+    T distance(const DVec<T>& left, const DVec<T>& right) {
+        if constexpr (std::is_same_v<T, float>) {
+            return sqrtf(distance2(left, right));
+        }
+        else {
+            return (T)sqrt(distance2(left, right));
+        }
+    }
+    template double distance<double>(const DVec<double>& left, const DVec<double>& right);
+    template float distance<float>(const DVec<float>& left, const DVec<float>& right);
+    template int distance<int>(const DVec<int>& left, const DVec<int>& right);
 
     template <typename T>
     void add(DVec<T>& result, const DVec<T>& left, const DVec<T>& right) {
@@ -179,6 +621,10 @@ namespace lia {
 
     template <typename T>
     void add(DMat<T>& result, const DMat<T>& left, const DMat<T>& right) {
+        if (left.layout() != result.layout() || right.layout() != result.layout()) {
+            _elementwise(result, [&](int i, int j) { return left(i, j) + right(i, j); });
+            return;
+        }
         const T* a = left.data();
         const T* b = right.data();
         const int d = right.ls * right.cs;
@@ -207,6 +653,10 @@ namespace lia {
 
     template <typename T>
     void sub(DMat<T>& result, const DMat<T>& left, const DMat<T>& right) {
+        if (left.layout() != result.layout() || right.layout() != result.layout()) {
+            _elementwise(result, [&](int i, int j) { return left(i, j) - right(i, j); });
+            return;
+        }
         const T* a = left.data();
         const T* b = right.data();
         const int d = right.ls * right.cs;
@@ -234,6 +684,10 @@ namespace lia {
 
     template <typename T>
     void mul(DMat<T>& result, const DMat<T>& left, T right) {
+        if (left.layout() != result.layout()) {
+            _elementwise(result, [&](int i, int j) { return left(i, j) * right; });
+            return;
+        }
         const T* m = left.data();
         const int d = left.ls * left.cs;
         T* r = result.data();
@@ -260,6 +714,10 @@ namespace lia {
 
     template <typename T>
     void div(DMat<T>& result, const DMat<T>& left, T right) {
+        if (left.layout() != result.layout()) {
+            _elementwise(result, [&](int i, int j) { return left(i, j) / right; });
+            return;
+        }
         const T* m = left.data();
         const int d = left.ls * left.cs;
         T* r = result.data();
@@ -273,33 +731,42 @@ namespace lia {
 
     template <typename T>
     void dot(T& result, const DVec<T>& left, const DVec<T>& right) {
-        const T* a = left.data();
-        const T* b = right.data();
-        const int d = right.ls;
-        result = (T)0.0;
-        for (int i = 0; i < d; i++) {
-            result += a[i]*b[i];
-        }
+        dot(result, left, right, REDUCE_FAST);
     }
     template void dot(double& result, const DVec<double>& left, const DVec<double>& right);
     template void dot(float& result, const DVec<float>& left, const DVec<float>& right);
     template void dot(int& result, const DVec<int>& left, const DVec<int>& right);
+
+    template <typename T>
+    void dot(T& result, const DVec<T>& left, const DVec<T>& right, ReduceMode mode) {
+        const T* a = left.data();
+        const T* b = right.data();
+        result = _reduce<T>(right.ls, mode, [=](int begin, int end) { return _dotRange(&a[begin], &b[begin], end - begin); });
+    }
+    template void dot(double& result, const DVec<double>& left, const DVec<double>& right, ReduceMode mode);
+    template void dot(float& result, const DVec<float>& left, const DVec<float>& right, ReduceMode mode);
+    template void dot(int& result, const DVec<int>& left, const DVec<int>& right, ReduceMode mode);
     
     template <typename T>
     void dot(DVec<T>& result, const DMat<T>& left, const DVec<T>& right) {
+        if (left.layout() != LAYOUT_ROW_MAJOR) {
+            gemv(result, left, false, right, (T)1, (T)0);
+            return;
+        }
         const T* da = left.data();
         const T* db = right.data();
-        const int ls = left.ls;
         const int d = right.ls;
         T* r = result.data();
-        for (int i = 0; i < ls; i++) {
-            const T* line = &da[i*d];
-            T* const sum = &r[i];
-            *sum = 0;
-            for (int j = 0; j < d; j++) {
-                *sum += line[j]*db[j];
+        _parallelLines(left.ls, (int64_t)left.ls*d, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                const T* line = &da[i*d];
+                T* const sum = &r[i];
+                *sum = 0;
+                for (int j = 0; j < d; j++) {
+                    *sum += line[j]*db[j];
+                }
             }
-        }
+        });
     }
     template void dot(DVec<double>& result, const DMat<double>& left, const DVec<double>& right);
     template void dot(DVec<float>& result, const DMat<float>& left, const DVec<float>& right);
@@ -307,29 +774,583 @@ namespace lia {
 
     template <typename T>
     void dot(DMat<T>& result, const DMat<T>& left, const DMat<T>& right) {
+        if (left.layout() != LAYOUT_ROW_MAJOR || right.layout() != LAYOUT_ROW_MAJOR || result.layout() != LAYOUT_ROW_MAJOR) {
+            dot(result, left, false, right, false);
+            return;
+        }
         const T* da = left.data();
         const T* db = right.data();
         const int a = left.ls;
         const int b = left.cs;
         const int c = right.cs;
         T* r = result.data();
-        for (int i = 0; i < a; i++) {
-            const T* line = &da[i*b];
-            for (int j = 0; j < c; j++) {
-                const T* col = &db[j];
-                T* const sum = &r[i*c + j];
-                *sum = 0;
-                for (int k = 0; k < b; k++) {
-                    *sum += line[k] * (*col);
-                    col += c;
+        _parallelLines(a, (int64_t)a*b*c, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                const T* line = &da[i*b];
+                for (int j = 0; j < c; j++) {
+                    const T* col = &db[j];
+                    T* const sum = &r[i*c + j];
+                    *sum = 0;
+                    for (int k = 0; k < b; k++) {
+                        *sum += line[k] * (*col);
+                        col += c;
+                    }
                 }
             }
-        }
+        });
     }
     template void dot(DMat<double>& result, const DMat<double>& left, const DMat<double>& right);
     template void dot(DMat<float>& result, const DMat<float>& left, const DMat<float>& right);
     template void dot(DMat<int>& result, const DMat<int>& left, const DMat<int>& right);
 
+    // Accumulate alpha * transpose(lines begin to end of a) * x into r, four lines at a time to cut the traffic on r
+    template <typename T>
+    static void _tdotLines(T* r, const T* a, const T* x, T alpha, int cs, int begin, int end) {
+        int i = begin;
+        for (; i + 4 <= end; i += 4) {
+            const T* const l0 = &a[i*cs];
+            const T* const l1 = &l0[cs];
+            const T* const l2 = &l1[cs];
+            const T* const l3 = &l2[cs];
+            const T x0 = alpha*x[i];
+            const T x1 = alpha*x[i + 1];
+            const T x2 = alpha*x[i + 2];
+            const T x3 = alpha*x[i + 3];
+            for (int j = 0; j < cs; j++) { r[j] += l0[j]*x0 + l1[j]*x1 + l2[j]*x2 + l3[j]*x3; }
+        }
+        for (; i < end; i++) {
+            const T* const line = &a[i*cs];
+            const T xi = alpha*x[i];
+            for (int j = 0; j < cs; j++) { r[j] += line[j]*xi; }
+        }
+    }
+
+    // Transposed GEMV. Tall matrices are split in blocks of lines, each thread accumulating its own partial result.
+    template <typename T>
+    static void _gemvT(T* r, const T* a, const T* x, T alpha, T beta, int ls, int cs) {
+        for (int j = 0; j < cs; j++) { r[j] = (beta == (T)0) ? (T)0 : beta*r[j]; }
+        ThreadPool& pool = ThreadPool::global();
+        const int chunks = pool.threads();
+        if ((int64_t)ls*cs < LIA_PARALLEL_MIN_WORK || chunks == 1 || ls < 2*chunks) {
+            _tdotLines(r, a, x, alpha, cs, 0, ls);
+            return;
+        }
+        std::vector<T> partials((size_t)chunks*cs, (T)0);
+        pool.run(chunks, [&](int id) {
+            int begin, end;
+            partition(ls, chunks, id, begin, end);
+            _tdotLines(&partials[(size_t)id*cs], a, x, alpha, cs, begin, end);
+        });
+        for (int id = 0; id < chunks; id++) {
+            const T* const p = &partials[(size_t)id*cs];
+            for (int j = 0; j < cs; j++) { r[j] += p[j]; }
+        }
+    }
+
+    template <typename T>
+    void tdot(DVec<T>& result, const DMat<T>& left, const DVec<T>& right) {
+        gemv(result, left, true, right, (T)1, (T)0);
+    }
+    template void tdot(DVec<double>& result, const DMat<double>& left, const DVec<double>& right);
+    template void tdot(DVec<float>& result, const DMat<float>& left, const DVec<float>& right);
+    template void tdot(DVec<int>& result, const DMat<int>& left, const DVec<int>& right);
+
+    template <typename T>
+    void gemv(DVec<T>& result, const DMat<T>& left, bool transposed, const DVec<T>& right, T alpha, T beta) {
+        // A column-major matrix is the row-major storage of its transpose
+        const bool rowMajor = (left.layout() == LAYOUT_ROW_MAJOR);
+        const T* da = left.data();
+        const T* x = right.data();
+        const int ls = rowMajor ? left.ls : left.cs;
+        const int cs = rowMajor ? left.cs : left.ls;
+        T* r = result.data();
+        if (transposed == rowMajor) {
+            _gemvT(r, da, x, alpha, beta, ls, cs);
+            return;
+        }
+        _parallelLines(ls, (int64_t)ls*cs, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                const T* line = &da[i*cs];
+                T sum = 0;
+                for (int j = 0; j < cs; j++) { sum += line[j]*x[j]; }
+                r[i] = (beta == (T)0) ? alpha*sum : alpha*sum + beta*r[i];
+            }
+        });
+    }
+    template void gemv(DVec<double>& result, const DMat<double>& left, bool transposed, const DVec<double>& right, double alpha, double beta);
+    template void gemv(DVec<float>& result, const DMat<float>& left, bool transposed, const DVec<float>& right, float alpha, float beta);
+    template void gemv(DVec<int>& result, const DMat<int>& left, bool transposed, const DVec<int>& right, int alpha, int beta);
+
+    // Product of row-major buffers, either of which can be read as its transpose. The buffers are lt ? b x a : a x b
+    // and rt ? c x b : b x c with lcs and rcs elements per line, the result is a x c.
+    template <typename T>
+    static void _dotBuffers(T* r, const T* da, bool leftTransposed, int lcs, const T* db, bool rightTransposed, int rcs, int a, int b, int c) {
+        _parallelLines(a, (int64_t)a*b*c, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                T* const line = &r[i*c];
+                if (leftTransposed && !rightTransposed) {
+                    // Accumulate the lines of the right-hand side weighted by column i of the left-hand side
+                    for (int j = 0; j < c; j++) { line[j] = 0; }
+                    for (int k = 0; k < b; k++) {
+                        const T x = da[k*lcs + i];
+                        const T* const rl = &db[k*rcs];
+                        for (int j = 0; j < c; j++) { line[j] += x*rl[j]; }
+                    }
+                }
+                else if (!leftTransposed && !rightTransposed) {
+                    const T* const ll = &da[i*lcs];
+                    for (int j = 0; j < c; j++) {
+                        const T* col = &db[j];
+                        T sum = 0;
+                        for (int k = 0; k < b; k++) {
+                            sum += ll[k] * (*col);
+                            col += rcs;
+                        }
+                        line[j] = sum;
+                    }
+                }
+                else if (!leftTransposed) {
+                    // Both operands are read along their lines
+                    const T* const ll = &da[i*lcs];
+                    for (int j = 0; j < c; j++) {
+                        const T* const rl = &db[j*rcs];
+                        T sum = 0;
+                        for (int k = 0; k < b; k++) { sum += ll[k]*rl[k]; }
+                        line[j] = sum;
+                    }
+                }
+                else {
+                    for (int j = 0; j < c; j++) {
+                        const T* const rl = &db[j*rcs];
+                        T sum = 0;
+                        for (int k = 0; k < b; k++) { sum += da[k*lcs + i]*rl[k]; }
+                        line[j] = sum;
+                    }
+                }
+            }
+        });
+    }
+
+    template <typename T>
+    void dot(DMat<T>& result, const DMat<T>& left, bool leftTransposed, const DMat<T>& right, bool rightTransposed) {
+        // Column-major matrices are the row-major storage of their transpose
+        const bool lrow = (left.layout() == LAYOUT_ROW_MAJOR);
+        const bool rrow = (right.layout() == LAYOUT_ROW_MAJOR);
+        const bool lt = (leftTransposed == lrow);
+        const bool rt = (rightTransposed == rrow);
+        const int lcs = lrow ? left.cs : left.ls;
+        const int rcs = rrow ? right.cs : right.ls;
+        const int a = leftTransposed ? left.cs : left.ls;
+        const int b = leftTransposed ? left.ls : left.cs;
+        const int c = rightTransposed ? right.ls : right.cs;
+
+        // A column-major result is computed as the row-major transpose(right) * transpose(left)
+        if (result.layout() == LAYOUT_ROW_MAJOR) {
+            _dotBuffers(result.data(), left.data(), lt, lcs, right.data(), rt, rcs, a, b, c);
+        }
+        else {
+            _dotBuffers(result.data(), right.data(), !rt, rcs, left.data(), !lt, lcs, c, b, a);
+        }
+    }
+    template void dot(DMat<double>& result, const DMat<double>& left, bool leftTransposed, const DMat<double>& right, bool rightTransposed);
+    template void dot(DMat<float>& result, const DMat<float>& left, bool leftTransposed, const DMat<float>& right, bool rightTransposed);
+    template void dot(DMat<int>& result, const DMat<int>& left, bool leftTransposed, const DMat<int>& right, bool rightTransposed);
+
+    // Number of bytes of the value processed together by the Gram matrix, kept in cache while the triangle is updated
+#ifndef LIA_GRAM_BLOCK_BYTES
+    #define LIA_GRAM_BLOCK_BYTES    (256 << 10)
+#endif
+
+    // Split the lines of a triangle into chunks holding the same number of elements
+    static std::vector<int> _triangleBounds(int n, int chunks, bool lower) {
+        // Line i of the lower triangle holds i + 1 elements, the lines before it hold i*(i+1)/2 elements
+        std::vector<int> bounds(chunks + 1);
+        const int64_t total = (int64_t)n*(n + 1) / 2;
+        int i = 0;
+        for (int k = 0; k < chunks; k++) {
+            while (i < n && (int64_t)i*(i + 1) / 2 < total*k / chunks) { i++; }
+            bounds[k] = i;
+        }
+        bounds[chunks] = n;
+
+        // Line i of the upper triangle holds as many elements as line n - 1 - i of the lower triangle
+        if (!lower) {
+            std::vector<int> lowerBounds = bounds;
+            for (int k = 0; k <= chunks; k++) { bounds[k] = n - lowerBounds[chunks - k]; }
+        }
+        return bounds;
+    }
+
+    // Accumulate some lines of a triangle of transpose(block) * block for a row-major block of lines
+    template <typename T>
+    static void _gramBlock(T* r, const T* block, int lines, int cs, bool lower, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            T* const line = &r[i*cs];
+            const int jb = lower ? 0 : i;
+            const int je = lower ? i + 1 : cs;
+
+            // Four lines of the block at a time to load and store the line of the result less often
+            int k = 0;
+            for (; k + 4 <= lines; k += 4) {
+                const T* const v0 = &block[k*cs];
+                const T* const v1 = v0 + cs;
+                const T* const v2 = v1 + cs;
+                const T* const v3 = v2 + cs;
+                const T x0 = v0[i];
+                const T x1 = v1[i];
+                const T x2 = v2[i];
+                const T x3 = v3[i];
+                for (int j = jb; j < je; j++) { line[j] += (x0*v0[j] + x1*v1[j]) + (x2*v2[j] + x3*v3[j]); }
+            }
+            for (; k < lines; k++) {
+                const T* const vl = &block[k*cs];
+                const T x = vl[i];
+                for (int j = jb; j < je; j++) { line[j] += x*vl[j]; }
+            }
+        }
+    }
+
+    // Compute a triangle of transpose(value) * value into a row-major buffer
+    template <typename T>
+    static void _gramTriangle(T* r, const DMat<T>& value, bool lower) {
+        const T* da = value.data();
+        const int ls = value.ls;
+        const int cs = value.cs;
+        if (!cs) { return; }
+
+        // Split the lines of the triangle between the threads so that they all update the same number of elements
+        ThreadPool& pool = ThreadPool::global();
+        const int chunks = ((int64_t)ls*cs*cs / 2 < LIA_PARALLEL_MIN_WORK || cs < 2) ? 1 : std::min<int>(pool.threads(), cs);
+        const std::vector<int> bounds = _triangleBounds(cs, chunks, lower);
+
+        // Clear the triangle
+        pool.run(chunks, [&](int id) {
+            for (int i = bounds[id]; i < bounds[id + 1]; i++) {
+                const int jb = lower ? 0 : i;
+                const int je = lower ? i + 1 : cs;
+                for (int j = jb; j < je; j++) { r[i*cs + j] = 0; }
+            }
+        });
+
+        // Stream the value once, by blocks of lines that stay in cache while every thread updates its lines
+        const int blockLines = std::max<int>(4, LIA_GRAM_BLOCK_BYTES / (cs*sizeof(T)));
+        for (int b = 0; b < ls; b += blockLines) {
+            const int lines = std::min<int>(blockLines, ls - b);
+            if (value.layout() == LAYOUT_ROW_MAJOR) {
+                const T* block = &da[(size_t)b*cs];
+                pool.run(chunks, [&](int id) {
+                    _gramBlock(r, block, lines, cs, lower, bounds[id], bounds[id + 1]);
+                });
+            }
+            else {
+                // A column-major value is the row-major storage of its transpose, the block is a range of each column
+                pool.run(chunks, [&](int id) {
+                    for (int i = bounds[id]; i < bounds[id + 1]; i++) {
+                        const T* const ci = &da[(size_t)i*ls + b];
+                        const int jb = lower ? 0 : i;
+                        const int je = lower ? i + 1 : cs;
+                        for (int j = jb; j < je; j++) { r[i*cs + j] += _dotRange(ci, &da[(size_t)j*ls + b], lines); }
+                    }
+                });
+            }
+        }
+    }
+
+    template <typename T>
+    void gram(DMat<T>& result, const DMat<T>& value) {
+        // Compute the lower half and mirror it into the upper half, the layout of the result doesn't matter
+        T* r = result.data();
+        const int cs = value.cs;
+        _gramTriangle(r, value, true);
+        for (int i = 0; i < cs; i++) {
+            for (int j = i + 1; j < cs; j++) { r[i*cs + j] = r[j*cs + i]; }
+        }
+    }
+    template void gram(DMat<double>& result, const DMat<double>& value);
+    template void gram(DMat<float>& result, const DMat<float>& value);
+    template void gram(DMat<int>& result, const DMat<int>& value);
+
+    template <typename T>
+    void gram(DMat<T>& result, const DMat<T>& value, Uplo uplo) {
+        // The lower triangle of a column-major result is the upper triangle of its row-major storage
+        const bool lower = ((uplo == UPLO_LOWER) == (result.layout() == LAYOUT_ROW_MAJOR));
+        _gramTriangle(result.data(), value, lower);
+    }
+    template void gram(DMat<double>& result, const DMat<double>& value, Uplo uplo);
+    template void gram(DMat<float>& result, const DMat<float>& value, Uplo uplo);
+    template void gram(DMat<int>& result, const DMat<int>& value, Uplo uplo);
+
+    template <typename T>
+    void ger(DMat<T>& result, const DVec<T>& left, const DVec<T>& right, T alpha) {
+        // A column-major matrix is updated through its row-major transpose
+        const bool rowMajor = (result.layout() == LAYOUT_ROW_MAJOR);
+        const T* x = rowMajor ? left.data() : right.data();
+        const T* y = rowMajor ? right.data() : left.data();
+        const int ls = rowMajor ? result.ls : result.cs;
+        const int cs = rowMajor ? result.cs : result.ls;
+        T* r = result.data();
+        _parallelLines(ls, (int64_t)ls*cs, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                T* const line = &r[i*cs];
+                const T s = alpha*x[i];
+                for (int j = 0; j < cs; j++) { line[j] += s*y[j]; }
+            }
+        });
+    }
+    template void ger(DMat<double>& result, const DVec<double>& left, const DVec<double>& right, double alpha);
+    template void ger(DMat<float>& result, const DVec<float>& left, const DVec<float>& right, float alpha);
+    template void ger(DMat<int>& result, const DVec<int>& left, const DVec<int>& right, int alpha);
+
+    // Number of lines under which the Strassen-Winograd recursion switches to the classical product
+#ifndef LIA_STRASSEN_CROSSOVER
+    #define LIA_STRASSEN_CROSSOVER  128
+#endif
+
+    // Classical product of square blocks stored with the given line strides
+    template <typename T>
+    static void _dotBlock(T* c, int64_t ldc, const T* a, int64_t lda, const T* b, int64_t ldb, int m) {
+        _parallelLines(m, (int64_t)m*m*m, [=](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                T* const line = &c[i*ldc];
+                for (int j = 0; j < m; j++) { line[j] = 0; }
+                for (int k = 0; k < m; k++) {
+                    const T x = a[i*lda + k];
+                    const T* const col = &b[k*ldb];
+                    for (int j = 0; j < m; j++) { line[j] += x*col[j]; }
+                }
+            }
+        });
+    }
+
+    // Sum of square blocks stored with the given line strides
+    template <typename T>
+    static void _addBlock(T* r, int64_t ldr, const T* a, int64_t lda, const T* b, int64_t ldb, int m) {
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < m; j++) { r[i*ldr + j] = a[i*lda + j] + b[i*ldb + j]; }
+        }
+    }
+
+    // Difference of square blocks stored with the given line strides
+    template <typename T>
+    static void _subBlock(T* r, int64_t ldr, const T* a, int64_t lda, const T* b, int64_t ldb, int m) {
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < m; j++) { r[i*ldr + j] = a[i*lda + j] - b[i*ldb + j]; }
+        }
+    }
+
+    int64_t strassenWorkspace(int size) {
+        int64_t total = 0;
+        for (int m = size; m > LIA_STRASSEN_CROSSOVER; m /= 2) {
+            const int64_t h = m / 2;
+            total += 2*h*h;
+        }
+        return total;
+    }
+
+    // Strassen-Winograd product of square blocks. Uses the schedule of Boyer et al. (Memory efficient scheduling of
+    // Strassen-Winograd's matrix multiplication algorithm, 2009) which only needs two temporaries per level, the
+    // products being computed in the quadrants of the result.
+    template <typename T>
+    static void _strassen(T* c, int64_t ldc, const T* a, int64_t lda, const T* b, int64_t ldb, int m, T* work) {
+        if (m <= LIA_STRASSEN_CROSSOVER) {
+            _dotBlock(c, ldc, a, lda, b, ldb, m);
+            return;
+        }
+
+        // Odd sizes recurse on the even leading block and add the last line and column afterwards
+        const int h = m / 2;
+        const T* a11 = a;          const T* a12 = &a[h];
+        const T* a21 = &a[h*lda];  const T* a22 = &a[h*lda + h];
+        const T* b11 = b;          const T* b12 = &b[h];
+        const T* b21 = &b[h*ldb];  const T* b22 = &b[h*ldb + h];
+        T* c11 = c;                T* c12 = &c[h];
+        T* c21 = &c[h*ldc];        T* c22 = &c[h*ldc + h];
+        T* x = work;
+        T* y = &work[(int64_t)h*h];
+        T* next = &work[2*(int64_t)h*h];
+
+        _subBlock(x, h, a11, lda, a21, lda, h);             // S3 = A11 - A21
+        _subBlock(y, h, b22, ldb, b12, ldb, h);             // T3 = B22 - B12
+        _strassen(c21, ldc, x, h, y, h, h, next);           // P7 = S3*T3
+        _addBlock(x, h, a21, lda, a22, lda, h);             // S1 = A21 + A22
+        _subBlock(y, h, b12, ldb, b11, ldb, h);             // T1 = B12 - B11
+        _strassen(c22, ldc, x, h, y, h, h, next);           // P5 = S1*T1
+        _subBlock(x, h, x, h, a11, lda, h);                 // S2 = S1 - A11
+        _subBlock(y, h, b22, ldb, y, h, h);                 // T2 = B22 - T1
+        _strassen(c12, ldc, x, h, y, h, h, next);           // P6 = S2*T2
+        _subBlock(x, h, a12, lda, x, h, h);                 // S4 = A12 - S2
+        _strassen(c11, ldc, x, h, b22, ldb, h, next);       // P3 = S4*B22
+        _strassen(x, h, a11, lda, b11, ldb, h, next);       // P1 = A11*B11
+        _addBlock(c12, ldc, x, h, c12, ldc, h);             // U2 = P1 + P6
+        _addBlock(c21, ldc, c12, ldc, c21, ldc, h);         // U3 = U2 + P7
+        _addBlock(c12, ldc, c12, ldc, c22, ldc, h);         // U4 = U2 + P5
+        _addBlock(c22, ldc, c21, ldc, c22, ldc, h);         // U7 = U3 + P5
+        _addBlock(c12, ldc, c12, ldc, c11, ldc, h);         // U5 = U4 + P3
+        _subBlock(y, h, y, h, b21, ldb, h);                 // T4 = T2 - B21
+        _strassen(c11, ldc, a22, lda, y, h, h, next);       // P4 = A22*T4
+        _subBlock(c21, ldc, c21, ldc, c11, ldc, h);         // U6 = U3 - P4
+        _strassen(c11, ldc, a12, lda, b21, ldb, h, next);   // P2 = A12*B21
+        _addBlock(c11, ldc, x, h, c11, ldc, h);             // U1 = P1 + P2
+
+        if (m == 2*h) { return; }
+        const int e = m - 1;
+
+        // Contribution of the last column of the left-hand side and last line of the right-hand side to the leading block
+        for (int i = 0; i < e; i++) {
+            const T v = a[i*lda + e];
+            T* const line = &c[i*ldc];
+            for (int j = 0; j < e; j++) { line[j] += v*b[e*ldb + j]; }
+        }
+
+        // Last column of the result
+        for (int i = 0; i < m; i++) {
+            T sum = 0;
+            for (int k = 0; k < m; k++) { sum += a[i*lda + k]*b[k*ldb + e]; }
+            c[i*ldc + e] = sum;
+        }
+
+        // Last line of the result
+        T* const last = &c[e*ldc];
+        for (int j = 0; j < e; j++) { last[j] = 0; }
+        for (int k = 0; k < m; k++) {
+            const T v = a[e*lda + k];
+            for (int j = 0; j < e; j++) { last[j] += v*b[k*ldb + j]; }
+        }
+    }
+
+    template <typename T>
+    void dot(DMat<T>& result, const DMat<T>& left, const DMat<T>& right, DotAlgo algo, T* workspace) {
+        const int m = left.ls;
+        const bool rowMajor = (left.layout() == LAYOUT_ROW_MAJOR && right.layout() == LAYOUT_ROW_MAJOR && result.layout() == LAYOUT_ROW_MAJOR);
+        if (algo == DOT_CLASSICAL || m != left.cs || m != right.cs || !rowMajor) {
+            dot(result, left, right);
+            return;
+        }
+
+        // Allocate the workspace for the call if none was given, the recursion itself never allocates
+        T* work = workspace;
+        if (!work) { work = new T[std::max<int64_t>(strassenWorkspace(m), 1)]; }
+        _strassen(result.data(), m, left.data(), m, right.data(), m, m, work);
+        if (!workspace) { delete[] work; }
+    }
+    template void dot(DMat<double>& result, const DMat<double>& left, const DMat<double>& right, DotAlgo algo, double* workspace);
+    template void dot(DMat<float>& result, const DMat<float>& left, const DMat<float>& right, DotAlgo algo, float* workspace);
+    template void dot(DMat<int>& result, const DMat<int>& left, const DMat<int>& right, DotAlgo algo, int* workspace);
+
+    // Error constant of a Strassen-Winograd product following the recursion, n^2 at the classical leaves. An odd size
+    // adds one term to every sum of the even block.
+    static double _strassenErrorConstant(int m) {
+        if (m <= LIA_STRASSEN_CROSSOVER) { return (double)m*m; }
+        const int h = m / 2;
+        return 18.0*_strassenErrorConstant(h) + 96.0*h + (m & 1)*m;
+    }
+
+    template <typename T>
+    T dotErrorBound(const DMat<T>& left, const DMat<T>& right, DotAlgo algo) {
+        if constexpr (std::is_integral_v<T>) {
+            return 0;
+        }
+        else {
+            const T* a = left.data();
+            const T* b = right.data();
+            T na = 0, nb = 0;
+            for (int64_t i = 0; i < (int64_t)left.ls*left.cs; i++) { na = std::max<T>(na, fabs(a[i])); }
+            for (int64_t i = 0; i < (int64_t)right.ls*right.cs; i++) { nb = std::max<T>(nb, fabs(b[i])); }
+            const int n = left.cs;
+            const bool strassen = (algo == DOT_STRASSEN && left.ls == n && right.cs == n);
+            const double constant = strassen ? _strassenErrorConstant(n) : (double)n*n;
+            return (T)(constant * std::numeric_limits<T>::epsilon() / 2.0) * na * nb;
+        }
+    }
+    template double dotErrorBound(const DMat<double>& left, const DMat<double>& right, DotAlgo algo);
+    template float dotErrorBound(const DMat<float>& left, const DMat<float>& right, DotAlgo algo);
+    template int dotErrorBound(const DMat<int>& left, const DMat<int>& right, DotAlgo algo);
+
+    // Product of a small matrix pair of any size
+    template <typename T>
+    static void _dotSmall(T* r, const T* a, const T* b, int ls, int is, int cs) {
+        for (int i = 0; i < ls; i++) {
+            T* const line = &r[i*cs];
+            for (int j = 0; j < cs; j++) { line[j] = 0; }
+            for (int k = 0; k < is; k++) {
+                const T x = a[i*is + k];
+                const T* const col = &b[k*cs];
+                for (int j = 0; j < cs; j++) { line[j] += x*col[j]; }
+            }
+        }
+    }
+
+    // Product of a small matrix pair with sizes known at compile time, accumulating each line in registers
+    template <typename T, int L, int I, int C>
+    static void _dotSmall(T* r, const T* a, const T* b, int, int, int) {
+        for (int i = 0; i < L; i++) {
+            T acc[C];
+            for (int j = 0; j < C; j++) { acc[j] = 0; }
+            for (int k = 0; k < I; k++) {
+                const T x = a[i*I + k];
+                for (int j = 0; j < C; j++) { acc[j] += x*b[k*C + j]; }
+            }
+            for (int j = 0; j < C; j++) { r[i*C + j] = acc[j]; }
+        }
+    }
+
+    // Select the micro-kernel of a batch, specialized for the common square sizes
+    template <typename T>
+    static void (*_dotSmallKernel(int ls, int is, int cs))(T*, const T*, const T*, int, int, int) {
+        if (ls == is && is == cs) {
+            switch (ls) {
+                case 2: return _dotSmall<T, 2, 2, 2>;
+                case 3: return _dotSmall<T, 3, 3, 3>;
+                case 4: return _dotSmall<T, 4, 4, 4>;
+                case 8: return _dotSmall<T, 8, 8, 8>;
+                case 16: return _dotSmall<T, 16, 16, 16>;
+                case 32: return _dotSmall<T, 32, 32, 32>;
+                case 64: return _dotSmall<T, 64, 64, 64>;
+                default: break;
+            }
+        }
+        return _dotSmall<T>;
+    }
+
+    // Run a batch of small products, the operands of each product being given by a function of its index
+    template <typename T, class F>
+    static LIA_FORCE_INLINE void _dotBatch(int count, int ls, int is, int cs, F operands) {
+        const auto kernel = _dotSmallKernel<T>(ls, is, cs);
+        _parallelLines(count, (int64_t)count*ls*is*cs, [=](int begin, int end) {
+            for (int n = begin; n < end; n++) {
+                T* r;
+                const T* a;
+                const T* b;
+                operands(n, r, a, b);
+                kernel(r, a, b, ls, is, cs);
+            }
+        });
+    }
+
+    template <typename T>
+    void dot(T* result, int64_t resultStride, const T* left, int64_t leftStride, const T* right, int64_t rightStride, int count, int lines, int inner, int columns) {
+        _dotBatch<T>(count, lines, inner, columns, [=](int n, T*& r, const T*& a, const T*& b) {
+            r = &result[n*resultStride];
+            a = &left[n*leftStride];
+            b = &right[n*rightStride];
+        });
+    }
+    template void dot(double* result, int64_t resultStride, const double* left, int64_t leftStride, const double* right, int64_t rightStride, int count, int lines, int inner, int columns);
+    template void dot(float* result, int64_t resultStride, const float* left, int64_t leftStride, const float* right, int64_t rightStride, int count, int lines, int inner, int columns);
+    template void dot(int* result, int64_t resultStride, const int* left, int64_t leftStride, const int* right, int64_t rightStride, int count, int lines, int inner, int columns);
+
+    template <typename T>
+    void dot(T* const* results, const T* const* lefts, const T* const* rights, int count, int lines, int inner, int columns) {
+        _dotBatch<T>(count, lines, inner, columns, [=](int n, T*& r, const T*& a, const T*& b) {
+            r = results[n];
+            a = lefts[n];
+            b = rights[n];
+        });
+    }
+    template void dot(double* const* results, const double* const* lefts, const double* const* rights, int count, int lines, int inner, int columns);
+    template void dot(float* const* results, const float* const* lefts, const float* const* rights, int count, int lines, int inner, int columns);
+    template void dot(int* const* results, const int* const* lefts, const int* const* rights, int count, int lines, int inner, int columns);
+
     template <typename T>
     void cross(DVec<T>& result, const DVec<T>& left, const DVec<T>& right) {
         const T* a = left.data();
@@ -342,4 +1363,186 @@ namespace lia {
     template void cross(DVec<double>& result, const DVec<double>& left, const DVec<double>& right);
     template void cross(DVec<float>& result, const DVec<float>& left, const DVec<float>& right);
     template void cross(DVec<int>& result, const DVec<int>& left, const DVec<int>& right);
+
+    // Granularity the inner dimension of the packed int8 buffers is zero padded to
+    #define LIA_QDOT_ALIGN  32
+
+    // Largest inner dimension whose int32 accumulators can't overflow, 255*128*65535 < 2^31 with the VNNI bias
+    #define LIA_QDOT_MAX_INNER  65535
+
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+    #define LIA_QDOT_DPBUSD _mm256_dpbusd_epi32
+#elif defined(__AVXVNNI__)
+    #define LIA_QDOT_DPBUSD _mm256_dpbusd_avx_epi32
+#endif
+
+#ifdef LIA_QDOT_DPBUSD
+    // vpdpbusd multiplies unsigned by signed bytes, the left-hand side is biased by 128 to make it unsigned
+    static const int QDOT_BIAS = 128;
+#else
+    static const int QDOT_BIAS = 0;
+#endif
+
+#if defined(__AVX2__)
+    static LIA_FORCE_INLINE int _hsum(__m256i v) {
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s);
+    }
+#endif
+
+    // Packed int8 micro-kernel computing one line of the left-hand side against four columns of the right-hand side
+    static LIA_FORCE_INLINE void _qdot1x4(int* r, const int8_t* a, const int8_t* b, int kp) {
+        const int8_t* b0 = b;
+        const int8_t* b1 = &b[kp];
+        const int8_t* b2 = &b[2*kp];
+        const int8_t* b3 = &b[3*kp];
+#if defined(LIA_QDOT_DPBUSD)
+        const __m256i bias = _mm256_set1_epi8((char)0x80);
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        for (int k = 0; k < kp; k += 32) {
+            __m256i va = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)&a[k]), bias);
+            s0 = LIA_QDOT_DPBUSD(s0, va, _mm256_loadu_si256((const __m256i*)&b0[k]));
+            s1 = LIA_QDOT_DPBUSD(s1, va, _mm256_loadu_si256((const __m256i*)&b1[k]));
+            s2 = LIA_QDOT_DPBUSD(s2, va, _mm256_loadu_si256((const __m256i*)&b2[k]));
+            s3 = LIA_QDOT_DPBUSD(s3, va, _mm256_loadu_si256((const __m256i*)&b3[k]));
+        }
+        r[0] = _hsum(s0); r[1] = _hsum(s1); r[2] = _hsum(s2); r[3] = _hsum(s3);
+#elif defined(__AVX2__)
+        // Sign extend to int16 and use vpmaddwd, vpmaddubsw would saturate on signed by signed products
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        for (int k = 0; k < kp; k += 16) {
+            __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&a[k]));
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&b0[k]))));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&b1[k]))));
+            s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&b2[k]))));
+            s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&b3[k]))));
+        }
+        r[0] = _hsum(s0); r[1] = _hsum(s1); r[2] = _hsum(s2); r[3] = _hsum(s3);
+#else
+        int s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (int k = 0; k < kp; k++) {
+            const int va = a[k];
+            s0 += va*b0[k];
+            s1 += va*b1[k];
+            s2 += va*b2[k];
+            s3 += va*b3[k];
+        }
+        r[0] = s0; r[1] = s1; r[2] = s2; r[3] = s3;
+#endif
+    }
+
+    // Packed int8 micro-kernel computing one line of the left-hand side against one column of the right-hand side
+    static LIA_FORCE_INLINE int _qdot1x1(const int8_t* a, const int8_t* b, int kp) {
+#if defined(LIA_QDOT_DPBUSD)
+        const __m256i bias = _mm256_set1_epi8((char)0x80);
+        __m256i s = _mm256_setzero_si256();
+        for (int k = 0; k < kp; k += 32) {
+            __m256i va = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)&a[k]), bias);
+            s = LIA_QDOT_DPBUSD(s, va, _mm256_loadu_si256((const __m256i*)&b[k]));
+        }
+        return _hsum(s);
+#elif defined(__AVX2__)
+        __m256i s = _mm256_setzero_si256();
+        for (int k = 0; k < kp; k += 16) {
+            __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&a[k]));
+            s = _mm256_add_epi32(s, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&b[k]))));
+        }
+        return _hsum(s);
+#else
+        int s = 0;
+        for (int k = 0; k < kp; k++) {
+            s += a[k]*b[k];
+        }
+        return s;
+#endif
+    }
+
+    // Quantized dot product driver, calls the epilogue with each zero point corrected accumulator
+    template <class E>
+    static void _qdot(const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq, E epilogue) {
+        const int8_t* da = left.data();
+        const int8_t* db = right.data();
+        const int a = left.ls;
+        const int b = left.cs;
+        const int c = right.cs;
+        if (b > LIA_QDOT_MAX_INNER) { throw std::invalid_argument("Inner dimension too large for int32 accumulation"); }
+        const int kp = ((b + LIA_QDOT_ALIGN - 1) / LIA_QDOT_ALIGN) * LIA_QDOT_ALIGN;
+
+        // Pack the lines of the left-hand side and the columns of the right-hand side into zero padded rows
+        int8_t* pa = new int8_t[a*kp];
+        int8_t* pb = new int8_t[c*kp];
+        int* lsum = new int[a];
+        int* csum = new int[c];
+        memset(pa, 0, a*kp);
+        memset(pb, 0, c*kp);
+        for (int i = 0; i < a; i++) {
+            int8_t* p = &pa[i*kp];
+            int sum = 0;
+            for (int k = 0; k < b; k++) {
+                p[k] = da[left.index(i, k)];
+                sum += p[k];
+            }
+            lsum[i] = sum;
+        }
+        for (int j = 0; j < c; j++) { csum[j] = 0; }
+        for (int k = 0; k < b; k++) {
+            for (int j = 0; j < c; j++) {
+                const int8_t x = db[right.index(k, j)];
+                pb[j*kp + k] = x;
+                csum[j] += x;
+            }
+        }
+
+        // Run the micro-kernels and apply the zero point correction
+        for (int i = 0; i < a; i++) {
+            const int8_t* line = &pa[i*kp];
+            const int za = lq.zero(i);
+            int acc[4];
+            int j = 0;
+            for (; j + 4 <= c; j += 4) {
+                _qdot1x4(acc, line, &pb[j*kp], kp);
+                for (int l = 0; l < 4; l++) {
+                    const int zb = rq.zero(j + l);
+                    epilogue(i, j + l, acc[l] - (za + QDOT_BIAS)*csum[j + l] - zb*lsum[i] + b*za*zb);
+                }
+            }
+            for (; j < c; j++) {
+                const int zb = rq.zero(j);
+                epilogue(i, j, _qdot1x1(line, &pb[j*kp], kp) - (za + QDOT_BIAS)*csum[j] - zb*lsum[i] + b*za*zb);
+            }
+        }
+
+        // Free the packed buffers
+        delete[] pa;
+        delete[] pb;
+        delete[] lsum;
+        delete[] csum;
+    }
+
+    void dot(DMat<int>& result, const DMat<int8_t>& left, const DMat<int8_t>& right) {
+        _qdot(left, QParams(), right, QParams(), [&result](int i, int j, int acc) {
+            result(i, j) = acc;
+        });
+    }
+
+    void dot(DMat<int>& result, const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq) {
+        _qdot(left, lq, right, rq, [&result](int i, int j, int acc) {
+            result(i, j) = acc;
+        });
+    }
+
+    void dot(DMat<float>& result, const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq) {
+        _qdot(left, lq, right, rq, [&result, &lq, &rq](int i, int j, int acc) {
+            result(i, j) = lq.scale(i) * rq.scale(j) * (float)acc;
+        });
+    }
+
+    void dot(DMat<int8_t>& result, const QParams& resq, const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq) {
+        _qdot(left, lq, right, rq, [&result, &resq, &lq, &rq](int i, int j, int acc) {
+            const int q = (int)lrintf((float)acc * (lq.scale(i) * rq.scale(j) / resq.scale(j))) + resq.zero(j);
+            result(i, j) = (int8_t)(q < -128 ? -128 : (q > 127 ? 127 : q));
+        });
+    }
 }
\ No newline at end of file
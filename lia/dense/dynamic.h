@@ -1,7 +1,81 @@
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
 #include "../force_inline.h"
 
+// Number of elements stored inside the matrix object instead of on the heap, must be the same in every translation unit
+#ifndef LIA_DMAT_INLINE_SIZE
+#define LIA_DMAT_INLINE_SIZE    16
+#endif
+
 namespace lia {
+    /**
+     * Memory allocation policy of a dynamic matrix.
+    */
+    enum Alloc {
+        // Heap allocation for small buffers, transparent huge pages from LIA_HUGE_PAGE_THRESHOLD bytes upwards
+        ALLOC_DEFAULT,
+
+        // Regular heap allocation
+        ALLOC_HEAP,
+
+        // 2MB aligned mapping advised to be backed by transparent huge pages. The kernel may ignore the advice, and
+        // whether huge pages help depends on the machine, the demo measures their effect on a large product
+        ALLOC_TRANSPARENT_HUGE_PAGES,
+
+        // Explicit 2MB huge pages, requires pages reserved by the system. Falls back to transparent huge pages
+        ALLOC_HUGE_PAGES,
+
+        // Pages interleaved across all NUMA nodes. Where interleaving isn't supported, such as on a single node
+        // machine, falls back to transparent huge pages from LIA_HUGE_PAGE_THRESHOLD bytes upwards and the heap below
+        ALLOC_NUMA_INTERLEAVE,
+
+        // Pages first touched by the worker of the global pool that processes the same lines in the parallel
+        // kernels, which places them on that worker's NUMA node. The workers of the global pool get pinned. Falls
+        // back to interleaving when the workers can't be pinned or are busy, such as when allocating from a task,
+        // or on a single node machine.
+        ALLOC_NUMA_FIRST_TOUCH,
+
+        // Inline buffer inside the matrix object, used by default and heap policies up to LIA_DMAT_INLINE_SIZE elements
+        ALLOC_INLINE
+    };
+
+    /**
+     * Storage order of a dynamic matrix. Matrices with a single line or column are stored the same way in both.
+     * The dot products, transposes and element-wise operations accept any mix of layouts, the other kernels expect
+     * row-major matrices.
+    */
+    enum Layout {
+        // Lines stored one after the other
+        LAYOUT_ROW_MAJOR,
+
+        // Columns stored one after the other, as produced by Fortran and LAPACK style code
+        LAYOUT_COLUMN_MAJOR
+    };
+
+    /**
+     * Triangle of a matrix.
+    */
+    enum Uplo {
+        // Elements on and below the diagonal
+        UPLO_LOWER,
+
+        // Elements on and above the diagonal
+        UPLO_UPPER
+    };
+
+    /**
+     * Order of the operations of the vector reductions (dot product and norm).
+    */
+    enum ReduceMode {
+        // One partial result per thread of the global pool, the rounding depends on the number of threads
+        REDUCE_FAST,
+
+        // Partial results over fixed blocks of LIA_REDUCE_BLOCK elements combined by a fixed pairwise tree, giving
+        // bit-identical results for any number of threads
+        REDUCE_REPRODUCIBLE
+    };
+
     /**
      * Dynamically allocated dense matrix.
     */
@@ -18,18 +92,98 @@ namespace lia {
         */
         DMat(int lines, int columns);
 
+        /**
+         * Create a matrix with a specific allocation policy. Falls back to the heap if the policy isn't supported.
+         * Large NUMA allocations are also advised to use transparent huge pages.
+         * @param lines Number of lines.
+         * @param columns Number of columns.
+         * @param alloc Allocation policy of the data buffer.
+        */
+        DMat(int lines, int columns, Alloc alloc);
+
+        /**
+         * Create a matrix with a specific storage order.
+         * @param lines Number of lines.
+         * @param columns Number of columns.
+         * @param layout Storage order of the elements.
+         * @param alloc Allocation policy of the data buffer.
+        */
+        DMat(int lines, int columns, Layout layout, Alloc alloc = ALLOC_DEFAULT);
+
+        /**
+         * Create a matrix viewing an existing buffer. The buffer is not copied and won't be freed by the matrix.
+         * @param lines Number of lines.
+         * @param columns Number of columns.
+         * @param buffer Buffer containing the matrix data.
+        */
+        DMat(int lines, int columns, DT* buffer);
+
+        /**
+         * Create a matrix viewing an existing buffer with a specific storage order, such as a column-major array
+         * produced by Fortran code. The buffer is not copied and won't be freed by the matrix.
+         * @param lines Number of lines.
+         * @param columns Number of columns.
+         * @param buffer Buffer containing the matrix data.
+         * @param layout Storage order of the buffer.
+        */
+        DMat(int lines, int columns, DT* buffer, Layout layout);
+
         // Copy constructor
         DMat(const DMat& copy);
 
         // Move constructor
-        DMat(DMat&& move);
+        DMat(DMat&& move) noexcept;
 
         // Destructor
         ~DMat();
 
+        // Copy assignment operator, reuses the data buffer if it's large enough
+        DMat& operator=(const DMat& copy);
+
+        // Move assignment operator
+        DMat& operator=(DMat&& move) noexcept;
+
+        /**
+         * Change the size of the matrix. The elements are kept in the same storage order, new elements are left
+         * uninitialized. The data buffer is only reallocated if the new size exceeds the capacity.
+         * @param lines New number of lines.
+         * @param columns New number of columns.
+        */
+        void resize(int lines, int columns);
+
+        /**
+         * Change the shape of the matrix without changing its number of elements or touching its data.
+         * Throws std::invalid_argument if the number of elements differs.
+         * @param lines New number of lines.
+         * @param columns New number of columns.
+        */
+        void reshape(int lines, int columns);
+
+        /**
+         * Make sure the data buffer can hold a number of elements without being reallocated.
+         * @param elements Minimum capacity in number of elements.
+        */
+        void reserve(int elements);
+
+        /**
+         * Get the number of elements the data buffer can hold without being reallocated.
+         * @return Capacity in number of elements.
+        */
+        constexpr LIA_FORCE_INLINE int capacity() const { return _capacity; }
+
         // Function operator to access elements
-        constexpr LIA_FORCE_INLINE DT& operator()(int line, int column = 0) { return _data[line*cs + column]; }
-        constexpr LIA_FORCE_INLINE const DT& operator()(int line, int column = 0) const { return _data[line*cs + column]; }
+        constexpr LIA_FORCE_INLINE DT& operator()(int line, int column = 0) { return _data[index(line, column)]; }
+        constexpr LIA_FORCE_INLINE const DT& operator()(int line, int column = 0) const { return _data[index(line, column)]; }
+
+        /**
+         * Get the position of an element in the data buffer.
+         * @param line Line of the element.
+         * @param column Column of the element.
+         * @return Index of the element in the data buffer.
+        */
+        constexpr LIA_FORCE_INLINE int index(int line, int column) const {
+            return (_layout == LAYOUT_ROW_MAJOR) ? (line*cs + column) : (column*ls + line);
+        }
 
         // Array operator to access the data
         constexpr LIA_FORCE_INLINE DT& operator[](int id) { return _data[id]; }
@@ -42,15 +196,50 @@ namespace lia {
         constexpr LIA_FORCE_INLINE DT* data() { return _data; }
         constexpr LIA_FORCE_INLINE const DT* data() const { return _data; }
 
-        // Number of lines
-        const int ls;
+        /**
+         * Get the allocation policy actually used for the data buffer.
+         * @return Allocation policy.
+        */
+        constexpr LIA_FORCE_INLINE Alloc alloc() const { return _alloc; }
+
+        /**
+         * Get the storage order of the elements.
+         * @return Layout of the data buffer.
+        */
+        constexpr LIA_FORCE_INLINE Layout layout() const { return _layout; }
+
+        // Number of lines (read-only, use resize or reshape to change it)
+        int ls;
 
-        // Number of columns
-        const int cs;
+        // Number of columns (read-only, use resize or reshape to change it)
+        int cs;
 
     private:
+        // Get a buffer for a number of elements, the inline one if it fits and the policy allows it. The capacity of
+        // the buffer is only written once it was obtained
+        DT* acquire(int lines, int columns, Alloc& alloc, int& capacity);
+
+        // Replace the data buffer by a new one with enough capacity, optionally keeping the elements
+        void realloc(int lines, int columns, bool keep);
+
         // Raw matrix data
         DT* _data;
+
+        // Number of elements the data buffer can hold
+        int _capacity;
+
+        // Whether the data buffer is owned by the matrix
+        bool _owned;
+
+        // Allocation policy requested by the user and policy actually used for the data buffer
+        Alloc _request;
+        Alloc _alloc;
+
+        // Storage order of the elements
+        Layout _layout;
+
+        // Inline storage for small matrices
+        DT _inline[LIA_DMAT_INLINE_SIZE > 0 ? LIA_DMAT_INLINE_SIZE : 1];
     };
 
     /**
@@ -67,15 +256,68 @@ namespace lia {
          * @param lines Number of lines.
         */
         DVec(int lines);
+
+        /**
+         * Create a vector viewing an existing buffer. The buffer is not copied and won't be freed by the vector.
+         * @param lines Number of lines.
+         * @param buffer Buffer containing the vector data.
+        */
+        DVec(int lines, DT* buffer);
+
+        /**
+         * Change the size of the vector. The elements are kept, new elements are left uninitialized.
+         * The data buffer is only reallocated if the new size exceeds the capacity.
+         * @param lines New number of lines.
+        */
+        void resize(int lines) { DMat<DT>::resize(lines, 1); }
     };
 
     // Common dynamic vector and matrix types
     using DVecd = DVec<double>;
     using DVecf = DVec<float>;
     using DVeci = DVec<int>;
+    using DVeci8 = DVec<int8_t>;
     using DMatd = DMat<double>;
     using DMatf = DMat<float>;
     using DMati = DMat<int>;
+    using DMati8 = DMat<int8_t>;
+
+    /**
+     * Quantization parameters of an int8 matrix. A quantized value q represents the real value scale*(q - zero).
+     * The parameters are either shared by the whole matrix or given per line (left-hand operand) or per column
+     * (right-hand operand and result).
+    */
+    class QParams {
+    public:
+        /**
+         * Create per-tensor quantization parameters.
+         * @param scale Scale shared by all elements.
+         * @param zero Zero point shared by all elements.
+        */
+        QParams(float scale = 1.0f, int zero = 0);
+
+        /**
+         * Create per-line or per-column quantization parameters. The vectors are referenced, not copied.
+         * @param scales Scale of each line or column.
+         * @param zeros Zero point of each line or column.
+        */
+        QParams(const DVec<float>& scales, const DVec<int>& zeros);
+
+        // Get the scale of a line or column
+        constexpr LIA_FORCE_INLINE float scale(int id) const { return _scales ? _scales[id] : _scale; }
+
+        // Get the zero point of a line or column
+        constexpr LIA_FORCE_INLINE int zero(int id) const { return _zeros ? _zeros[id] : _zero; }
+
+    private:
+        // Per-tensor parameters
+        float _scale;
+        int _zero;
+
+        // Per-line or per-column parameters (NULL if per-tensor)
+        const float* _scales;
+        const int* _zeros;
+    };
 
     // ================================= CAST =================================
 
@@ -118,13 +360,50 @@ namespace lia {
     // ================================= NORM =================================
 
     /**
-     * Compute the euclidian norm of a vector.
+     * Compute the euclidian norm of a vector, with the REDUCE_FAST order of operations.
      * @param value Vector to take the euclidian norm of.
      * @return Euclidian norm of the vector.
     */
     template <typename T>
     T norm(const DVec<T>& value);
 
+    /**
+     * Compute the euclidian norm of a vector with a given order of operations.
+     * @param value Vector to take the euclidian norm of.
+     * @param mode Order of the operations of the sum of squares.
+     * @return Euclidian norm of the vector.
+    */
+    template <typename T>
+    T norm(const DVec<T>& value, ReduceMode mode);
+
+    /**
+     * Scale a vector to unit norm.
+     * @param result Vector to write the result to.
+     * @param value Vector to normalize.
+    */
+    template <typename T>
+    void normalize(DVec<T>& result, const DVec<T>& value);
+
+    // =============================== DISTANCE ===============================
+
+    /**
+     * Compute the squared euclidian distance between two vectors.
+     * @param left First vector.
+     * @param right Second vector.
+     * @return Squared euclidian distance between the vectors.
+    */
+    template <typename T>
+    T distance2(const DVec<T>& left, const DVec<T>& right);
+
+    /**
+     * Compute the euclidian distance between two vectors.
+     * @param left First vector.
+     * @param right Second vector.
+     * @return Euclidian distance between the vectors.
+    */
+    template <typename T>
+    T distance(const DVec<T>& left, const DVec<T>& right);
+
     // =============================== ADDITION ===============================
 
     /**
@@ -180,7 +459,7 @@ namespace lia {
     // ============================== DOT PRODUCT ==============================
 
     /**
-     * Take the dot product between two vector or matrices.
+     * Take the dot product between two vector or matrices. Vector dot products use the REDUCE_FAST order of operations.
      * @param result Matrix, vector or scalar to write the result to.
      * @param left Left-hand matrix or vector.
      * @param right Right-hand matrix or vector.
@@ -192,6 +471,202 @@ namespace lia {
     template <typename T>
     void dot(DMat<T>& result, const DMat<T>& left, const DMat<T>& right);
 
+    /**
+     * Take the dot product between two vectors with a given order of operations.
+     * @param result Scalar to write the result to.
+     * @param left Left-hand vector.
+     * @param right Right-hand vector.
+     * @param mode Order of the operations of the sum.
+    */
+    template <typename T>
+    void dot(T& result, const DVec<T>& left, const DVec<T>& right, ReduceMode mode);
+
+    /**
+     * Take the dot product between the transpose of a matrix and a vector, streaming the lines of the matrix once.
+     * @param result Vector to write the result to.
+     * @param left Left-hand matrix, used transposed.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    void tdot(DVec<T>& result, const DMat<T>& left, const DVec<T>& right);
+
+    /**
+     * Compute result = alpha * left * right + beta * result in a single pass (GEMV). The result isn't read if beta
+     * is zero.
+     * @param result Vector to update.
+     * @param left Left-hand matrix.
+     * @param transposed Whether to use the transpose of the left-hand matrix.
+     * @param right Right-hand vector.
+     * @param alpha Scale of the product.
+     * @param beta Scale of the previous result.
+    */
+    template <typename T>
+    void gemv(DVec<T>& result, const DMat<T>& left, bool transposed, const DVec<T>& right, T alpha, T beta);
+
+    /**
+     * Take the dot product between two matrices, either of which can be read as its transpose without materializing it.
+     * @param result Matrix to write the result to.
+     * @param left Left-hand matrix.
+     * @param leftTransposed Whether to use the transpose of the left-hand matrix.
+     * @param right Right-hand matrix.
+     * @param rightTransposed Whether to use the transpose of the right-hand matrix.
+    */
+    template <typename T>
+    void dot(DMat<T>& result, const DMat<T>& left, bool leftTransposed, const DMat<T>& right, bool rightTransposed);
+
+    // ============================== RANK UPDATES ==============================
+
+    /**
+     * Compute the Gram matrix transpose(value) * value (SYRK). Only the lower half is computed, the upper half being
+     * mirrored from it. The lines of the value are streamed from memory once, by blocks that stay in cache.
+     * @param result Square matrix with as many lines as the value has columns to write the result to.
+     * @param value Matrix to take the Gram matrix of.
+    */
+    template <typename T>
+    void gram(DMat<T>& result, const DMat<T>& value);
+
+    /**
+     * Compute one triangle of the Gram matrix transpose(value) * value (SYRK), the other triangle is left untouched.
+     * @param result Square matrix with as many lines as the value has columns to write the result to.
+     * @param value Matrix to take the Gram matrix of.
+     * @param uplo Triangle to compute, including the diagonal.
+    */
+    template <typename T>
+    void gram(DMat<T>& result, const DMat<T>& value, Uplo uplo);
+
+    /**
+     * Add the scaled outer product of two vectors to a matrix (GER), result += alpha * left * transpose(right).
+     * @param result Matrix to update.
+     * @param left Left-hand vector, with as many lines as the matrix.
+     * @param right Right-hand vector, with as many lines as the matrix has columns.
+     * @param alpha Scale of the outer product.
+    */
+    template <typename T>
+    void ger(DMat<T>& result, const DVec<T>& left, const DVec<T>& right, T alpha);
+
+    // ============================ FAST DOT PRODUCT ============================
+
+    /**
+     * Algorithm of a dense matrix product.
+    */
+    enum DotAlgo {
+        // Classical O(n^3) product, same as the regular dot product
+        DOT_CLASSICAL,
+
+        // Strassen-Winograd recursion in O(n^2.81) for square matrices, switching to the classical product below
+        // LIA_STRASSEN_CROSSOVER lines. Faster on large matrices but with a weaker error bound, see dotErrorBound
+        DOT_STRASSEN
+    };
+
+    /**
+     * Get the size of the workspace used by a Strassen-Winograd product.
+     * @param size Number of lines and columns of the square matrices.
+     * @return Number of elements of the workspace, about two thirds of a matrix.
+    */
+    int64_t strassenWorkspace(int size);
+
+    /**
+     * Take the dot product between two matrices with the given algorithm. Non-square products and matrices that
+     * aren't row-major always use the classical algorithm.
+     * @param result Matrix to write the result to.
+     * @param left Left-hand matrix.
+     * @param right Right-hand matrix.
+     * @param algo Algorithm to use.
+     * @param workspace Buffer of at least strassenWorkspace(size) elements, or NULL to allocate one for the call.
+    */
+    template <typename T>
+    void dot(DMat<T>& result, const DMat<T>& left, const DMat<T>& right, DotAlgo algo, T* workspace = NULL);
+
+    /**
+     * Get a first order bound on the absolute error of any element of a product. For the classical algorithm it is
+     * n^2 * u * max|left| * max|right|, Strassen-Winograd grows it to about 18^d * (n0^2 + 6*n0) instead of n^2 for
+     * a recursion of depth d down to blocks of n0 lines (Higham, Accuracy and Stability of Numerical Algorithms,
+     * 23.2.2). Integer products are exact.
+     * @param left Left-hand matrix.
+     * @param right Right-hand matrix.
+     * @param algo Algorithm of the product.
+     * @return Bound on the absolute error of the elements of the result.
+    */
+    template <typename T>
+    T dotErrorBound(const DMat<T>& left, const DMat<T>& right, DotAlgo algo);
+
+    // ========================== BATCHED DOT PRODUCT ==========================
+
+    /**
+     * Take the dot products of a batch of same-shape matrix pairs stored at a fixed distance from each other.
+     * A stride of zero reuses the same matrix for the whole batch. The batch is split across the global thread pool.
+     * @param result First result matrix.
+     * @param resultStride Distance in elements between two result matrices.
+     * @param left First left-hand matrix.
+     * @param leftStride Distance in elements between two left-hand matrices.
+     * @param right First right-hand matrix.
+     * @param rightStride Distance in elements between two right-hand matrices.
+     * @param count Number of products.
+     * @param lines Number of lines of the left-hand and result matrices.
+     * @param inner Number of columns of the left-hand matrices and of lines of the right-hand matrices.
+     * @param columns Number of columns of the right-hand and result matrices.
+    */
+    template <typename T>
+    void dot(T* result, int64_t resultStride, const T* left, int64_t leftStride, const T* right, int64_t rightStride, int count, int lines, int inner, int columns);
+
+    /**
+     * Take the dot products of a batch of same-shape matrix pairs given by arrays of pointers to their data.
+     * The batch is split across the global thread pool.
+     * @param results Result matrices.
+     * @param lefts Left-hand matrices.
+     * @param rights Right-hand matrices.
+     * @param count Number of products.
+     * @param lines Number of lines of the left-hand and result matrices.
+     * @param inner Number of columns of the left-hand matrices and of lines of the right-hand matrices.
+     * @param columns Number of columns of the right-hand and result matrices.
+    */
+    template <typename T>
+    void dot(T* const* results, const T* const* lefts, const T* const* rights, int count, int lines, int inner, int columns);
+
+    // ========================= QUANTIZED DOT PRODUCT =========================
+
+    /**
+     * Take the dot product between two int8 matrices, accumulating in int32. The inner dimension must not exceed
+     * 65535 so that the accumulators, biased by 128 on VNNI, can't overflow. Throws std::invalid_argument otherwise.
+     * With zero points, the corrected results must also fit in int32, which always holds up to an inner dimension
+     * of 33025. The operands and the result may use any layout.
+     * @param result Matrix to write the raw int32 accumulators to.
+     * @param left Left-hand matrix.
+     * @param right Right-hand matrix.
+    */
+    void dot(DMat<int>& result, const DMat<int8_t>& left, const DMat<int8_t>& right);
+
+    /**
+     * Take the dot product between two quantized int8 matrices with zero point correction.
+     * @param result Matrix to write the zero point corrected int32 accumulators to.
+     * @param left Left-hand matrix.
+     * @param lq Quantization parameters of the left-hand matrix (per-tensor or per-line).
+     * @param right Right-hand matrix.
+     * @param rq Quantization parameters of the right-hand matrix (per-tensor or per-column).
+    */
+    void dot(DMat<int>& result, const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq);
+
+    /**
+     * Take the dot product between two quantized int8 matrices and dequantize the result.
+     * @param result Matrix to write the dequantized result to.
+     * @param left Left-hand matrix.
+     * @param lq Quantization parameters of the left-hand matrix (per-tensor or per-line).
+     * @param right Right-hand matrix.
+     * @param rq Quantization parameters of the right-hand matrix (per-tensor or per-column).
+    */
+    void dot(DMat<float>& result, const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq);
+
+    /**
+     * Take the dot product between two quantized int8 matrices and requantize the result to int8.
+     * @param result Matrix to write the requantized result to.
+     * @param resq Quantization parameters of the result (per-tensor or per-column).
+     * @param left Left-hand matrix.
+     * @param lq Quantization parameters of the left-hand matrix (per-tensor or per-line).
+     * @param right Right-hand matrix.
+     * @param rq Quantization parameters of the right-hand matrix (per-tensor or per-column).
+    */
+    void dot(DMat<int8_t>& result, const QParams& resq, const DMat<int8_t>& left, const QParams& lq, const DMat<int8_t>& right, const QParams& rq);
+
     // ============================= CROSS PRODUCT =============================
 
     /**
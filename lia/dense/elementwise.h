@@ -0,0 +1,894 @@
+#pragma once
+#include "static.h"
+#include "dynamic.h"
+#include "../thread_pool.h"
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+// SSE2 versions of the math functions and of the kernels for functions that provide one
+#if defined(LIA_STATIC_SSE) && (defined(__SSE2__) || defined(_M_X64))
+#define LIA_ELEMENTWISE_SSE
+#include <emmintrin.h>
+#endif
+
+// Minimum number of elements per thread before an element-wise kernel is split across the global pool
+#ifndef LIA_ELEMENTWISE_MIN_CHUNK
+#define LIA_ELEMENTWISE_MIN_CHUNK   (1 << 16)
+#endif
+
+namespace lia {
+    // ============================= MATH FUNCTIONS =============================
+
+    // Reinterpret the bits of a float as an integer and back
+    static LIA_FORCE_INLINE int32_t _floatBits(float value) { int32_t bits; memcpy(&bits, &value, sizeof(float)); return bits; }
+    static LIA_FORCE_INLINE float _bitsFloat(int32_t bits) { float value; memcpy(&value, &bits, sizeof(float)); return value; }
+
+    // Range of the single-precision exponential, it overflows above ln(FLT_MAX) and is below half the smallest
+    // subnormal under the lower bound
+    #define LIA_EXPF_MAX    88.7228390f
+    #define LIA_EXPF_MIN    -103.972077f
+
+    // Single-precision exponential from the Cephes polynomial, the scalar and SSE versions use the same operations
+    static LIA_FORCE_INLINE float _expf(float x) {
+        const float in = x;
+        x = (x < LIA_EXPF_MIN) ? LIA_EXPF_MIN : x;
+        x = (x > LIA_EXPF_MAX) ? LIA_EXPF_MAX : x;
+
+        // Express exp(x) as 2^n * exp(g) with |g| <= ln(2)/2
+        const float fx = floorf(x*1.44269504088896341f + 0.5f);
+        x = x - fx*0.693359375f;
+        x = x - fx*-2.12194440e-4f;
+        const float z = x*x;
+        float y = 1.9875691500e-4f;
+        y = y*x + 1.3981999507e-3f;
+        y = y*x + 8.3334519073e-3f;
+        y = y*x + 4.1665795894e-2f;
+        y = y*x + 1.6666665459e-1f;
+        y = y*x + 5.0000001201e-1f;
+        y = (y*z + x) + 1.0f;
+
+        // Scale by 2^n in two steps so that n can reach the subnormals and 128
+        const int32_t n = (int32_t)fx;
+        const int32_t n1 = n >> 1;
+        y = (y*_bitsFloat((n1 + 127) << 23))*_bitsFloat((n - n1 + 127) << 23);
+        if (in != in) { return in; }
+        if (in > LIA_EXPF_MAX) { return INFINITY; }
+        return (in < LIA_EXPF_MIN) ? 0.0f : y;
+    }
+
+    // Single-precision natural logarithm from the Cephes polynomial
+    static LIA_FORCE_INLINE float _logf(float x) {
+        // Bring subnormals into the normal range
+        const float in = x;
+        const bool sub = (x < 1.17549435e-38f);
+        x = sub ? x*8388608.0f : x;
+
+        // Split into a mantissa in [sqrt(1/2), sqrt(2)) minus one and an exponent
+        const int32_t bits = _floatBits(x);
+        float e = (float)(((bits >> 23) & 0xff) - 127) + 1.0f;
+        e = e - (sub ? 23.0f : 0.0f);
+        const float m = _bitsFloat((bits & ~0x7f800000) | 0x3f000000);
+        const bool low = (m < 0.707106781186547524f);
+        x = (m - 1.0f) + (low ? m : 0.0f);
+        e = e - (low ? 1.0f : 0.0f);
+
+        const float z = x*x;
+        float y = 7.0376836292e-2f;
+        y = y*x - 1.1514610310e-1f;
+        y = y*x + 1.1676998740e-1f;
+        y = y*x - 1.2420140846e-1f;
+        y = y*x + 1.4249322787e-1f;
+        y = y*x - 1.6668057665e-1f;
+        y = y*x + 2.0000714765e-1f;
+        y = y*x - 2.4999993993e-1f;
+        y = y*x + 3.3333331174e-1f;
+        y = (y*x)*z;
+        y = y + e*-2.12194440e-4f;
+        y = y - z*0.5f;
+        x = (x + y) + e*0.693359375f;
+        if (in != in) { return in; }
+        if (in < 0.0f) { return NAN; }
+        if (in == 0.0f) { return -INFINITY; }
+        return (in == INFINITY) ? INFINITY : x;
+    }
+
+    // Single-precision hyperbolic tangent, Cephes polynomial for small inputs and 1 - 2/(exp(2x) + 1) otherwise
+    static LIA_FORCE_INLINE float _tanhf(float x) {
+        const float ax = fabsf(x);
+        const float z = x*x;
+        float p = -5.70498872745e-3f;
+        p = p*z + 2.06390887954e-2f;
+        p = p*z - 5.37397155531e-2f;
+        p = p*z + 1.33314422036e-1f;
+        p = p*z - 3.33332819422e-1f;
+        p = (p*z)*x + x;
+        const float l = copysignf(1.0f - 2.0f/(_expf(ax + ax) + 1.0f), x);
+        if (x != x) { return x; }
+        return (ax < 0.625f) ? p : l;
+    }
+
+#ifdef LIA_ELEMENTWISE_SSE
+    // Round down the lanes of an SSE register
+    static LIA_FORCE_INLINE __m128 _floor(__m128 x) {
+        const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+    }
+
+    // Evaluate a polynomial in x from its highest degree coefficient down
+    template <int n>
+    static LIA_FORCE_INLINE __m128 _poly(__m128 x, const float (&coeffs)[n]) {
+        __m128 y = _mm_set1_ps(coeffs[0]);
+        for (int i = 1; i < n; i++) { y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(coeffs[i])); }
+        return y;
+    }
+
+    // Select the lanes of a where the mask is set and the lanes of b elsewhere
+    static LIA_FORCE_INLINE __m128 _select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    static LIA_FORCE_INLINE __m128 _expf(__m128 x) {
+        static constexpr float coeffs[] = { 1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f, 4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f };
+        const __m128 in = x;
+        x = _mm_max_ps(x, _mm_set1_ps(LIA_EXPF_MIN));
+        x = _mm_min_ps(x, _mm_set1_ps(LIA_EXPF_MAX));
+        const __m128 fx = _floor(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f)));
+        x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+        x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+        const __m128 z = _mm_mul_ps(x, x);
+        __m128 y = _poly(x, coeffs);
+        y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.0f));
+
+        const __m128i n = _mm_cvttps_epi32(fx);
+        const __m128i n1 = _mm_srai_epi32(n, 1);
+        const __m128i s1 = _mm_slli_epi32(_mm_add_epi32(n1, _mm_set1_epi32(127)), 23);
+        const __m128i s2 = _mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(n, n1), _mm_set1_epi32(127)), 23);
+        y = _mm_mul_ps(_mm_mul_ps(y, _mm_castsi128_ps(s1)), _mm_castsi128_ps(s2));
+        y = _select(_mm_cmplt_ps(in, _mm_set1_ps(LIA_EXPF_MIN)), _mm_setzero_ps(), y);
+        y = _select(_mm_cmpgt_ps(in, _mm_set1_ps(LIA_EXPF_MAX)), _mm_set1_ps(INFINITY), y);
+        return _select(_mm_cmpunord_ps(in, in), in, y);
+    }
+
+    static LIA_FORCE_INLINE __m128 _logf(__m128 x) {
+        static constexpr float coeffs[] = { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f,
+                                            -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f };
+        const __m128 in = x;
+        const __m128 sub = _mm_cmplt_ps(x, _mm_set1_ps(1.17549435e-38f));
+        x = _select(sub, _mm_mul_ps(x, _mm_set1_ps(8388608.0f)), x);
+
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128i be = _mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff));
+        __m128 e = _mm_add_ps(_mm_cvtepi32_ps(_mm_sub_epi32(be, _mm_set1_epi32(127))), _mm_set1_ps(1.0f));
+        e = _mm_sub_ps(e, _mm_and_ps(sub, _mm_set1_ps(23.0f)));
+        const __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(~0x7f800000)), _mm_set1_epi32(0x3f000000)));
+        const __m128 low = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+        x = _mm_add_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_and_ps(low, m));
+        e = _mm_sub_ps(e, _mm_and_ps(low, _mm_set1_ps(1.0f)));
+
+        const __m128 z = _mm_mul_ps(x, x);
+        __m128 y = _mm_mul_ps(_mm_mul_ps(_poly(x, coeffs), x), z);
+        y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+        y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+        x = _mm_add_ps(_mm_add_ps(x, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+        x = _select(_mm_cmpeq_ps(in, _mm_set1_ps(INFINITY)), in, x);
+        x = _select(_mm_cmpeq_ps(in, _mm_setzero_ps()), _mm_set1_ps(-INFINITY), x);
+        x = _select(_mm_cmplt_ps(in, _mm_setzero_ps()), _mm_set1_ps(NAN), x);
+        return _select(_mm_cmpunord_ps(in, in), in, x);
+    }
+
+    static LIA_FORCE_INLINE __m128 _tanhf(__m128 x) {
+        static constexpr float coeffs[] = { -5.70498872745e-3f, 2.06390887954e-2f, -5.37397155531e-2f, 1.33314422036e-1f, -3.33332819422e-1f };
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        const __m128 ax = _mm_andnot_ps(sign, x);
+        const __m128 z = _mm_mul_ps(x, x);
+        const __m128 p = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_poly(z, coeffs), z), x), x);
+        const __m128 t = _expf(_mm_add_ps(ax, ax));
+        __m128 l = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(_mm_set1_ps(2.0f), _mm_add_ps(t, _mm_set1_ps(1.0f))));
+        l = _mm_or_ps(l, _mm_and_ps(sign, x));
+        const __m128 y = _select(_mm_cmplt_ps(ax, _mm_set1_ps(0.625f)), p, l);
+        return _select(_mm_cmpunord_ps(x, x), x, y);
+    }
+#endif
+
+    /**
+     * Exponential. Single precision uses a polynomial approximation with a relative error below 2e-7, or within one
+     * step for subnormal results, that is evaluated four elements at a time with SSE. Results above the float range
+     * are +inf, NaN inputs are propagated. Double precision uses the C library.
+    */
+    struct Exp {
+        static constexpr bool vectorized = true;
+        LIA_FORCE_INLINE float operator()(float x) const { return _expf(x); }
+        LIA_FORCE_INLINE double operator()(double x) const { return exp(x); }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 x) const { return _expf(x); }
+#endif
+    };
+
+    /**
+     * Natural logarithm. Single precision uses a polynomial approximation with an absolute error below 2e-7 plus a
+     * relative error below 2e-7, subnormal inputs included. Negative and NaN inputs give NaN, zero gives -inf and +inf
+     * gives +inf. Double precision uses the C library.
+    */
+    struct Log {
+        static constexpr bool vectorized = true;
+        LIA_FORCE_INLINE float operator()(float x) const { return _logf(x); }
+        LIA_FORCE_INLINE double operator()(double x) const { return log(x); }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 x) const { return _logf(x); }
+#endif
+    };
+
+    /**
+     * Hyperbolic tangent. Single precision uses a polynomial approximation with an absolute error below 3e-7 that
+     * propagates NaN inputs, double precision uses the C library.
+    */
+    struct Tanh {
+        static constexpr bool vectorized = true;
+        LIA_FORCE_INLINE float operator()(float x) const { return _tanhf(x); }
+        LIA_FORCE_INLINE double operator()(double x) const { return tanh(x); }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 x) const { return _tanhf(x); }
+#endif
+    };
+
+    // Absolute value, clearing the sign bit of floating point values so that -0 and negative NaNs match the SSE path
+    struct Abs {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T x) const {
+            if constexpr (std::is_floating_point_v<T>) { return fabs(x); }
+            else { return (x < 0) ? -x : x; }
+        }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 x) const { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+#endif
+    };
+
+    // Sum of two elements, to use with zip and reduce
+    struct Add {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T a, T b) const { return a + b; }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 a, __m128 b) const { return _mm_add_ps(a, b); }
+#endif
+    };
+
+    // Difference of two elements, to use with zip
+    struct Sub {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T a, T b) const { return a - b; }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 a, __m128 b) const { return _mm_sub_ps(a, b); }
+#endif
+    };
+
+    // Product of two elements, to use with zip and reduce
+    struct Mul {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T a, T b) const { return a * b; }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 a, __m128 b) const { return _mm_mul_ps(a, b); }
+#endif
+    };
+
+    // Quotient of two elements, to use with zip
+    struct Div {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T a, T b) const { return a / b; }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 a, __m128 b) const { return _mm_div_ps(a, b); }
+#endif
+    };
+
+    // Smallest of two elements, to use with zip and reduce
+    struct Min {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T a, T b) const { return (b < a) ? b : a; }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 a, __m128 b) const { return _mm_min_ps(b, a); }
+#endif
+    };
+
+    // Largest of two elements, to use with zip and reduce
+    struct Max {
+        static constexpr bool vectorized = true;
+        template <typename T>
+        constexpr LIA_FORCE_INLINE T operator()(T a, T b) const { return (a < b) ? b : a; }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 a, __m128 b) const { return _mm_max_ps(b, a); }
+#endif
+    };
+
+    /**
+     * Clamping of elements to a range.
+    */
+    template <typename T>
+    struct Clamp {
+        static constexpr bool vectorized = std::is_same_v<T, float>;
+
+        /**
+         * Create a clamping function.
+         * @param low Lower bound of the range.
+         * @param high Upper bound of the range.
+        */
+        constexpr Clamp(T low, T high) : low(low), high(high) {}
+
+        constexpr LIA_FORCE_INLINE T operator()(T x) const { return (x < low) ? low : ((high < x) ? high : x); }
+#ifdef LIA_ELEMENTWISE_SSE
+        LIA_FORCE_INLINE __m128 operator()(__m128 x) const {
+            return _mm_min_ps(_mm_set1_ps((float)high), _mm_max_ps(_mm_set1_ps((float)low), x));
+        }
+#endif
+
+        // Bounds of the range
+        T low;
+        T high;
+    };
+
+    /**
+     * Function marked as having an SSE version, see vectorize.
+    */
+    template <class F>
+    struct Vectorized : F {
+        static constexpr bool vectorized = true;
+    };
+
+    /**
+     * Mark a generic function composed of vectorized functions as vectorized itself, so that fused expressions such as
+     * an activation applied to a biased element run four single-precision elements at a time.
+     * @param f Function whose call operator accepts both elements and SSE registers, such as a generic lambda.
+     * @return Function marked as vectorized.
+    */
+    template <class F>
+    static constexpr LIA_FORCE_INLINE Vectorized<F> vectorize(F f) { return Vectorized<F>{ f }; }
+
+    // ============================== RANGE KERNELS ==============================
+
+    // Whether a function declares an SSE overload that processes four single-precision elements at a time
+    template <class F, class = void>
+    struct _isVectorized : std::false_type {};
+    template <class F>
+    struct _isVectorized<F, std::enable_if_t<F::vectorized>> : std::true_type {};
+
+    template <class F, typename... T>
+    static constexpr bool _useSSE() {
+#ifdef LIA_ELEMENTWISE_SSE
+        return _isVectorized<F>::value && (std::is_same_v<T, float> && ...);
+#else
+        return false;
+#endif
+    }
+
+    // Apply a unary function to a contiguous range
+    template <typename TR, typename T, class F>
+    static LIA_FORCE_INLINE void _mapRange(TR* r, const T* v, int count, const F& f) {
+        int i = 0;
+#ifdef LIA_ELEMENTWISE_SSE
+        if constexpr (_useSSE<F, TR, T>()) {
+            for (; i + 4 <= count; i += 4) { _mm_storeu_ps(&r[i], f(_mm_loadu_ps(&v[i]))); }
+        }
+#endif
+        for (; i < count; i++) { r[i] = (TR)f(v[i]); }
+    }
+
+    // Apply a binary function to contiguous ranges
+    template <typename TR, typename TA, typename TB, class F>
+    static LIA_FORCE_INLINE void _zipRange(TR* r, const TA* a, const TB* b, int count, const F& f) {
+        int i = 0;
+#ifdef LIA_ELEMENTWISE_SSE
+        if constexpr (_useSSE<F, TR, TA, TB>()) {
+            for (; i + 4 <= count; i += 4) { _mm_storeu_ps(&r[i], f(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i]))); }
+        }
+#endif
+        for (; i < count; i++) { r[i] = (TR)f(a[i], b[i]); }
+    }
+
+    // Apply a binary function to a contiguous range and a scalar
+    template <typename TR, typename TA, typename TB, class F>
+    static LIA_FORCE_INLINE void _zipScalarRange(TR* r, const TA* a, TB b, int count, const F& f) {
+        int i = 0;
+#ifdef LIA_ELEMENTWISE_SSE
+        if constexpr (_useSSE<F, TR, TA, TB>()) {
+            const __m128 bs = _mm_set1_ps(b);
+            for (; i + 4 <= count; i += 4) { _mm_storeu_ps(&r[i], f(_mm_loadu_ps(&a[i]), bs)); }
+        }
+#endif
+        for (; i < count; i++) { r[i] = (TR)f(a[i], b); }
+    }
+
+    // Fold a contiguous range into an accumulator, in four interleaved lanes when the function has an SSE version
+    template <typename T, class F>
+    static LIA_FORCE_INLINE T _foldRange(const T* v, int count, T acc, const F& f) {
+        int i = 0;
+#ifdef LIA_ELEMENTWISE_SSE
+        if constexpr (_useSSE<F, T>()) {
+            if (count >= 8) {
+                __m128 lanes = _mm_loadu_ps(v);
+                for (i = 4; i + 4 <= count; i += 4) { lanes = f(lanes, _mm_loadu_ps(&v[i])); }
+                alignas(16) float l[4];
+                _mm_store_ps(l, lanes);
+                acc = f(acc, f(f(l[0], l[1]), f(l[2], l[3])));
+            }
+        }
+#endif
+        for (; i < count; i++) { acc = f(acc, v[i]); }
+        return acc;
+    }
+
+    // Run a task over chunks of a range of items of a given number of elements each, inline for small ranges and
+    // across the global pool otherwise
+    template <class F>
+    static LIA_FORCE_INLINE void _chunks(int count, int size, F task) {
+        const int minChunk = std::max<int>(1, LIA_ELEMENTWISE_MIN_CHUNK / std::max<int>(1, size));
+        if (count < 2*minChunk) {
+            task(0, count);
+            return;
+        }
+        parallelFor(count, minChunk, task);
+    }
+
+    // Run a task producing a partial result over chunks of a range of items, returning the partial of each chunk
+    template <typename P, class F>
+    static LIA_FORCE_INLINE std::vector<P> _partials(int count, F task) {
+        ThreadPool& pool = ThreadPool::global();
+        int chunks = count / LIA_ELEMENTWISE_MIN_CHUNK;
+        if (chunks > pool.threads()) { chunks = pool.threads(); }
+        if (chunks < 2) { return std::vector<P>(1, task(0, count)); }
+        std::vector<P> partials(chunks);
+        pool.run(chunks, [&](int id) {
+            int begin, end;
+            partition(count, chunks, id, begin, end);
+            partials[id] = task(begin, end);
+        });
+        return partials;
+    }
+
+    // Fill a matrix element by element when its operands have a different layout, going through it in storage order
+    template <typename T, class F>
+    static LIA_FORCE_INLINE void _fillMixed(DMat<T>& result, F op) {
+        const int ls = result.ls;
+        const int cs = result.cs;
+        if (result.layout() == LAYOUT_ROW_MAJOR) {
+            for (int i = 0; i < ls; i++) {
+                for (int j = 0; j < cs; j++) { result(i, j) = op(i, j); }
+            }
+        }
+        else {
+            for (int j = 0; j < cs; j++) {
+                for (int i = 0; i < ls; i++) { result(i, j) = op(i, j); }
+            }
+        }
+    }
+
+    // =================================== MAP ===================================
+
+    /**
+     * Apply a function to every element of a matrix. Large matrices are split across the global thread pool, so the
+     * function must be safe to call concurrently.
+     * @param result Matrix to write the results to, can be the value itself.
+     * @param value Matrix to apply the function to.
+     * @param f Function taking an element and returning the result. Functions providing an SSE overload and a
+     * vectorized flag, like Exp, Log, Tanh, Abs and Clamp, are run four single-precision elements at a time.
+    */
+    template <typename TR, typename T, class F>
+    static void map(DMat<TR>& result, const DMat<T>& value, F f) {
+        if (result.layout() != value.layout()) {
+            _fillMixed(result, [&](int i, int j) { return (TR)f(value(i, j)); });
+            return;
+        }
+        TR* r = result.data();
+        const T* v = value.data();
+        _chunks(value.ls*value.cs, 1, [&](int begin, int end) { _mapRange(&r[begin], &v[begin], end - begin, f); });
+    }
+
+    /**
+     * Apply a function to every element of a matrix.
+     * @param result Matrix to write the results to, can be the value itself.
+     * @param value Matrix to apply the function to.
+     * @param f Function taking an element and returning the result.
+    */
+    template <int ls, int cs, typename TR, typename T, class F>
+    static constexpr LIA_FORCE_INLINE void map(SMat<ls, cs, TR>& result, const SMat<ls, cs, T>& value, F f) {
+        _staticFor<ls*cs>([&](auto i) { result.data[i] = (TR)f(value.data[i]); });
+    }
+
+    // =================================== ZIP ===================================
+
+    /**
+     * Apply a function to every pair of elements at the same position in two matrices. Large matrices are split
+     * across the global thread pool, so the function must be safe to call concurrently.
+     * @param result Matrix to write the results to, can be one of the operands.
+     * @param left Matrix of the first arguments.
+     * @param right Matrix of the second arguments.
+     * @param f Function taking two elements and returning the result. Functions providing an SSE overload and a
+     * vectorized flag, like Add, Sub, Mul, Div, Min and Max, are run four single-precision elements at a time.
+    */
+    template <typename TR, typename TA, typename TB, class F>
+    static void zip(DMat<TR>& result, const DMat<TA>& left, const DMat<TB>& right, F f) {
+        if (left.layout() != result.layout() || right.layout() != result.layout()) {
+            _fillMixed(result, [&](int i, int j) { return (TR)f(left(i, j), right(i, j)); });
+            return;
+        }
+        TR* r = result.data();
+        const TA* a = left.data();
+        const TB* b = right.data();
+        _chunks(left.ls*left.cs, 1, [&](int begin, int end) { _zipRange(&r[begin], &a[begin], &b[begin], end - begin, f); });
+    }
+
+    /**
+     * Apply a function to every pair of elements at the same position in two matrices.
+     * @param result Matrix to write the results to, can be one of the operands.
+     * @param left Matrix of the first arguments.
+     * @param right Matrix of the second arguments.
+     * @param f Function taking two elements and returning the result.
+    */
+    template <int ls, int cs, typename TR, typename TA, typename TB, class F>
+    static constexpr LIA_FORCE_INLINE void zip(SMat<ls, cs, TR>& result, const SMat<ls, cs, TA>& left, const SMat<ls, cs, TB>& right, F f) {
+        _staticFor<ls*cs>([&](auto i) { result.data[i] = (TR)f(left.data[i], right.data[i]); });
+    }
+
+    /**
+     * Multiply two matrices element by element (Hadamard product).
+     * @param result Matrix to write the result to, can be one of the operands.
+     * @param left Left-hand matrix.
+     * @param right Right-hand matrix.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void hadamard(DMat<T>& result, const DMat<T>& left, const DMat<T>& right) { zip(result, left, right, Mul()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void hadamard(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& left, const SMat<ls, cs, T>& right) {
+        zip(result, left, right, Mul());
+    }
+
+    /**
+     * Divide two matrices element by element.
+     * @param result Matrix to write the result to, can be one of the operands.
+     * @param left Matrix of the numerators.
+     * @param right Matrix of the denominators.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void ediv(DMat<T>& result, const DMat<T>& left, const DMat<T>& right) { zip(result, left, right, Div()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void ediv(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& left, const SMat<ls, cs, T>& right) {
+        zip(result, left, right, Div());
+    }
+
+    // ================================ BROADCAST ================================
+
+    /**
+     * Apply a function between every line of a matrix and a vector, such as adding a bias to every line. Large
+     * matrices are split across the global thread pool, so the function must be safe to call concurrently.
+     * @param result Matrix to write the results to, can be the value itself.
+     * @param value Matrix of the first arguments.
+     * @param vector Vector of the second arguments, with one element per column.
+     * @param f Function taking an element of the matrix and an element of the vector and returning the result.
+    */
+    template <typename TR, typename TA, typename TB, class F>
+    static void zipLines(DMat<TR>& result, const DMat<TA>& value, const DVec<TB>& vector, F f) {
+        if (result.layout() != value.layout()) {
+            _fillMixed(result, [&](int i, int j) { return (TR)f(value(i, j), vector[j]); });
+            return;
+        }
+        TR* r = result.data();
+        const TA* a = value.data();
+        const TB* b = vector.data();
+        const int ls = value.ls;
+        const int cs = value.cs;
+        if (value.layout() == LAYOUT_ROW_MAJOR) {
+            _chunks(ls, cs, [&](int begin, int end) {
+                for (int i = begin; i < end; i++) { _zipRange(&r[i*cs], &a[i*cs], b, cs, f); }
+            });
+        }
+        else {
+            _chunks(cs, ls, [&](int begin, int end) {
+                for (int j = begin; j < end; j++) { _zipScalarRange(&r[j*ls], &a[j*ls], b[j], ls, f); }
+            });
+        }
+    }
+
+    /**
+     * Apply a function between every column of a matrix and a vector, such as scaling every line by its own
+     * factor. Large matrices are split across the global thread pool, so the function must be safe to call
+     * concurrently.
+     * @param result Matrix to write the results to, can be the value itself.
+     * @param value Matrix of the first arguments.
+     * @param vector Vector of the second arguments, with one element per line.
+     * @param f Function taking an element of the matrix and an element of the vector and returning the result.
+    */
+    template <typename TR, typename TA, typename TB, class F>
+    static void zipColumns(DMat<TR>& result, const DMat<TA>& value, const DVec<TB>& vector, F f) {
+        if (result.layout() != value.layout()) {
+            _fillMixed(result, [&](int i, int j) { return (TR)f(value(i, j), vector[i]); });
+            return;
+        }
+        TR* r = result.data();
+        const TA* a = value.data();
+        const TB* b = vector.data();
+        const int ls = value.ls;
+        const int cs = value.cs;
+        if (value.layout() == LAYOUT_ROW_MAJOR) {
+            _chunks(ls, cs, [&](int begin, int end) {
+                for (int i = begin; i < end; i++) { _zipScalarRange(&r[i*cs], &a[i*cs], b[i], cs, f); }
+            });
+        }
+        else {
+            _chunks(cs, ls, [&](int begin, int end) {
+                for (int j = begin; j < end; j++) { _zipRange(&r[j*ls], &a[j*ls], b, ls, f); }
+            });
+        }
+    }
+
+    /**
+     * Apply a function between every line of a matrix and a vector.
+     * @param result Matrix to write the results to, can be the value itself.
+     * @param value Matrix of the first arguments.
+     * @param vector Vector of the second arguments, with one element per column.
+     * @param f Function taking an element of the matrix and an element of the vector and returning the result.
+    */
+    template <int ls, int cs, typename TR, typename TA, typename TB, class F>
+    static constexpr LIA_FORCE_INLINE void zipLines(SMat<ls, cs, TR>& result, const SMat<ls, cs, TA>& value, const SVec<cs, TB>& vector, F f) {
+        _staticFor<ls>([&](auto i) {
+            _staticFor<cs>([&](auto j) { result.data[i*cs + j] = (TR)f(value.data[i*cs + j], vector.data[j]); });
+        });
+    }
+
+    /**
+     * Apply a function between every column of a matrix and a vector.
+     * @param result Matrix to write the results to, can be the value itself.
+     * @param value Matrix of the first arguments.
+     * @param vector Vector of the second arguments, with one element per line.
+     * @param f Function taking an element of the matrix and an element of the vector and returning the result.
+    */
+    template <int ls, int cs, typename TR, typename TA, typename TB, class F>
+    static constexpr LIA_FORCE_INLINE void zipColumns(SMat<ls, cs, TR>& result, const SMat<ls, cs, TA>& value, const SVec<ls, TB>& vector, F f) {
+        _staticFor<ls>([&](auto i) {
+            _staticFor<cs>([&](auto j) { result.data[i*cs + j] = (TR)f(value.data[i*cs + j], vector.data[i]); });
+        });
+    }
+
+    /**
+     * Add, subtract or multiply a vector with one element per column to every line of a matrix.
+     * @param result Matrix to write the result to, can be the value itself.
+     * @param value Matrix to broadcast the vector over.
+     * @param vector Vector with one element per column.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void addLines(DMat<T>& result, const DMat<T>& value, const DVec<T>& vector) { zipLines(result, value, vector, Add()); }
+    template <typename T>
+    static LIA_FORCE_INLINE void subLines(DMat<T>& result, const DMat<T>& value, const DVec<T>& vector) { zipLines(result, value, vector, Sub()); }
+    template <typename T>
+    static LIA_FORCE_INLINE void mulLines(DMat<T>& result, const DMat<T>& value, const DVec<T>& vector) { zipLines(result, value, vector, Mul()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void addLines(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const SVec<cs, T>& vector) {
+        zipLines(result, value, vector, Add());
+    }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void subLines(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const SVec<cs, T>& vector) {
+        zipLines(result, value, vector, Sub());
+    }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void mulLines(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const SVec<cs, T>& vector) {
+        zipLines(result, value, vector, Mul());
+    }
+
+    /**
+     * Add, subtract or multiply a vector with one element per line to every column of a matrix.
+     * @param result Matrix to write the result to, can be the value itself.
+     * @param value Matrix to broadcast the vector over.
+     * @param vector Vector with one element per line.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void addColumns(DMat<T>& result, const DMat<T>& value, const DVec<T>& vector) { zipColumns(result, value, vector, Add()); }
+    template <typename T>
+    static LIA_FORCE_INLINE void subColumns(DMat<T>& result, const DMat<T>& value, const DVec<T>& vector) { zipColumns(result, value, vector, Sub()); }
+    template <typename T>
+    static LIA_FORCE_INLINE void mulColumns(DMat<T>& result, const DMat<T>& value, const DVec<T>& vector) { zipColumns(result, value, vector, Mul()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void addColumns(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const SVec<ls, T>& vector) {
+        zipColumns(result, value, vector, Add());
+    }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void subColumns(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const SVec<ls, T>& vector) {
+        zipColumns(result, value, vector, Sub());
+    }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void mulColumns(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const SVec<ls, T>& vector) {
+        zipColumns(result, value, vector, Mul());
+    }
+
+    // ================================= REDUCE =================================
+
+    /**
+     * Fold all the elements of a matrix with an associative function. Large matrices are split across the global
+     * thread pool and functions with an SSE version fold interleaved lanes, so the order of the operations isn't
+     * fixed.
+     * @param value Matrix to reduce.
+     * @param init Identity element of the function, such as zero for a sum.
+     * @param f Associative function combining two elements.
+     * @return Reduction of all the elements.
+    */
+    template <typename T, class F>
+    static T reduce(const DMat<T>& value, T init, F f) {
+        const T* v = value.data();
+        const std::vector<T> partials = _partials<T>(value.ls*value.cs, [&](int begin, int end) {
+            return _foldRange(&v[begin], end - begin, init, f);
+        });
+        T acc = init;
+        for (const T& p : partials) { acc = f(acc, p); }
+        return acc;
+    }
+
+    /**
+     * Fold all the elements of a matrix with a function, in storage order.
+     * @param value Matrix to reduce.
+     * @param init Initial value of the accumulator.
+     * @param f Function combining the accumulator with an element.
+     * @return Reduction of all the elements.
+    */
+    template <int ls, int cs, typename T, class F>
+    static constexpr LIA_FORCE_INLINE T reduce(const SMat<ls, cs, T>& value, T init, F f) {
+        T acc = init;
+        _staticFor<ls*cs>([&](auto i) { acc = f(acc, value.data[i]); });
+        return acc;
+    }
+
+    /**
+     * Fold each line of a matrix with an associative function.
+     * @param result Vector with one element per line to write the results to.
+     * @param value Matrix to reduce.
+     * @param init Identity element of the function, such as zero for a sum.
+     * @param f Associative function combining two elements.
+    */
+    template <typename T, class F>
+    static void reduceLines(DVec<T>& result, const DMat<T>& value, T init, F f) {
+        const T* v = value.data();
+        T* r = result.data();
+        const int ls = value.ls;
+        const int cs = value.cs;
+        if (value.layout() == LAYOUT_ROW_MAJOR) {
+            // Fold each contiguous line on its own
+            _chunks(ls, cs, [&](int begin, int end) {
+                for (int i = begin; i < end; i++) { r[i] = _foldRange(&v[i*cs], cs, init, f); }
+            });
+        }
+        else {
+            // Fold the stored columns into the result one after the other
+            for (int i = 0; i < ls; i++) { r[i] = init; }
+            _chunks(ls, cs, [&](int begin, int end) {
+                for (int j = 0; j < cs; j++) { _zipRange(&r[begin], &r[begin], &v[j*ls + begin], end - begin, f); }
+            });
+        }
+    }
+
+    /**
+     * Fold each column of a matrix with an associative function.
+     * @param result Vector with one element per column to write the results to.
+     * @param value Matrix to reduce.
+     * @param init Identity element of the function, such as zero for a sum.
+     * @param f Associative function combining two elements.
+    */
+    template <typename T, class F>
+    static void reduceColumns(DVec<T>& result, const DMat<T>& value, T init, F f) {
+        const T* v = value.data();
+        T* r = result.data();
+        const int ls = value.ls;
+        const int cs = value.cs;
+        if (value.layout() == LAYOUT_ROW_MAJOR) {
+            // Fold the lines into the result one after the other
+            for (int j = 0; j < cs; j++) { r[j] = init; }
+            _chunks(cs, ls, [&](int begin, int end) {
+                for (int i = 0; i < ls; i++) { _zipRange(&r[begin], &r[begin], &v[i*cs + begin], end - begin, f); }
+            });
+        }
+        else {
+            // Fold each contiguous stored column on its own
+            _chunks(cs, ls, [&](int begin, int end) {
+                for (int j = begin; j < end; j++) { r[j] = _foldRange(&v[j*ls], ls, init, f); }
+            });
+        }
+    }
+
+    /**
+     * Fold each line of a matrix with a function.
+     * @param result Vector with one element per line to write the results to.
+     * @param value Matrix to reduce.
+     * @param init Initial value of the accumulators.
+     * @param f Function combining an accumulator with an element.
+    */
+    template <int ls, int cs, typename T, class F>
+    static constexpr LIA_FORCE_INLINE void reduceLines(SVec<ls, T>& result, const SMat<ls, cs, T>& value, T init, F f) {
+        _staticFor<ls>([&](auto i) {
+            T acc = init;
+            _staticFor<cs>([&](auto j) { acc = f(acc, value.data[i*cs + j]); });
+            result.data[i] = acc;
+        });
+    }
+
+    /**
+     * Fold each column of a matrix with a function.
+     * @param result Vector with one element per column to write the results to.
+     * @param value Matrix to reduce.
+     * @param init Initial value of the accumulators.
+     * @param f Function combining an accumulator with an element.
+    */
+    template <int ls, int cs, typename T, class F>
+    static constexpr LIA_FORCE_INLINE void reduceColumns(SVec<cs, T>& result, const SMat<ls, cs, T>& value, T init, F f) {
+        _staticFor<cs>([&](auto j) { result.data[j] = init; });
+        _staticFor<ls>([&](auto i) {
+            _staticFor<cs>([&](auto j) { result.data[j] = f(result.data[j], value.data[i*cs + j]); });
+        });
+    }
+
+    // ============================ COMMON REDUCTIONS ============================
+
+    /**
+     * Sum all the elements of a matrix.
+     * @param value Matrix to sum.
+     * @return Sum of the elements.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE T sum(const DMat<T>& value) { return reduce(value, (T)0, Add()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE T sum(const SMat<ls, cs, T>& value) { return reduce(value, (T)0, Add()); }
+
+    /**
+     * Get the smallest element of a non-empty matrix.
+     * @param value Matrix to search.
+     * @return Smallest element.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE T min(const DMat<T>& value) { return reduce(value, value[0], Min()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE T min(const SMat<ls, cs, T>& value) { return reduce(value, value.data[0], Min()); }
+
+    /**
+     * Get the largest element of a non-empty matrix.
+     * @param value Matrix to search.
+     * @return Largest element.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE T max(const DMat<T>& value) { return reduce(value, value[0], Max()); }
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE T max(const SMat<ls, cs, T>& value) { return reduce(value, value.data[0], Max()); }
+
+    /**
+     * Find the position of the largest element of a non-empty matrix, the first one in storage order on ties.
+     * @param line Line of the largest element.
+     * @param column Column of the largest element.
+     * @param value Matrix to search.
+    */
+    template <typename T>
+    static void argmax(int& line, int& column, const DMat<T>& value) {
+        const T* v = value.data();
+        const std::vector<int> partials = _partials<int>(value.ls*value.cs, [&](int begin, int end) {
+            int best = begin;
+            for (int i = begin + 1; i < end; i++) {
+                if (v[best] < v[i]) { best = i; }
+            }
+            return best;
+        });
+        int best = partials[0];
+        for (int id : partials) {
+            if (v[best] < v[id]) { best = id; }
+        }
+        const int outer = (value.layout() == LAYOUT_ROW_MAJOR) ? value.cs : value.ls;
+        line = (value.layout() == LAYOUT_ROW_MAJOR) ? best / outer : best % outer;
+        column = (value.layout() == LAYOUT_ROW_MAJOR) ? best % outer : best / outer;
+    }
+
+    template <int ls, int cs, typename T>
+    static constexpr LIA_FORCE_INLINE void argmax(int& line, int& column, const SMat<ls, cs, T>& value) {
+        int best = 0;
+        for (int i = 1; i < ls*cs; i++) {
+            if (value.data[best] < value.data[i]) { best = i; }
+        }
+        line = best / cs;
+        column = best % cs;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "lazy.h"
+#include "../thread_pool.h"
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+
+namespace lia {
+    // Minimum amount of work (in elements or multiply-adds) per thread before a pass is split across threads
+#ifndef LIA_GRAPH_MIN_WORK
+    #define LIA_GRAPH_MIN_WORK  (1 << 16)
+#endif
+
+    // Sum a line or its squares with eight independent accumulators summed in a fixed order
+    template <bool squares, typename T>
+    static LIA_FORCE_INLINE T _reduceLine(const T* line, int count) {
+        T acc[8] = {};
+        int j = 0;
+        for (; j + 8 <= count; j += 8) {
+            for (int k = 0; k < 8; k++) { acc[k] += squares ? line[j + k]*line[j + k] : line[j + k]; }
+        }
+        for (int k = 0; j < count; j++, k++) { acc[k] += squares ? line[j]*line[j] : line[j]; }
+        return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    }
+
+    template <typename T>
+    const typename Graph<T>::_Node& Graph<T>::get(Node node, bool allowScalar) const {
+        if (node.id < 0 || node.id >= (int)_nodes.size()) { throw std::invalid_argument("Node doesn't belong to the graph"); }
+        const _Node& n = _nodes[node.id];
+        if (!allowScalar && (n.op == OP_NORM || n.op == OP_SUM)) { throw std::invalid_argument("Scalar nodes can only be used as outputs"); }
+        return n;
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::push(Op op, int a, int b, T scalar, int ls, int cs) {
+        _nodes.push_back({ op, a, b, scalar, ls, cs, NULL, NULL, NULL });
+        return Node{ (int)_nodes.size() - 1 };
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::input(const DMat<T>& value) {
+        if (value.layout() != LAYOUT_ROW_MAJOR && value.ls > 1 && value.cs > 1) { throw std::invalid_argument("Graph inputs must be row-major"); }
+        Node node = push(OP_INPUT, -1, -1, (T)0, value.ls, value.cs);
+        _nodes[node.id].input = &value;
+        return node;
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::dot(Node left, Node right) {
+        const _Node& l = get(left);
+        const _Node& r = get(right);
+        if (l.cs != r.ls) { throw std::invalid_argument("Dot product operands have incompatible sizes"); }
+        return push(OP_DOT, left.id, right.id, (T)0, l.ls, r.cs);
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::binary(Op op, Node left, Node right) {
+        const _Node& l = get(left);
+        const _Node& r = get(right);
+        if (l.ls != r.ls || l.cs != r.cs) { throw std::invalid_argument("Element-wise operands must have the same size"); }
+        return push(op, left.id, right.id, (T)0, l.ls, l.cs);
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::broadcast(Op op, Node value, Node vector) {
+        const _Node& m = get(value);
+        const _Node& v = get(vector);
+        if ((v.ls != 1 && v.cs != 1) || v.ls*v.cs != m.cs) { throw std::invalid_argument("Broadcast vector must have one element per column"); }
+        return push(op, value.id, vector.id, (T)0, m.ls, m.cs);
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::add(Node left, Node right) { return binary(OP_ADD, left, right); }
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::sub(Node left, Node right) { return binary(OP_SUB, left, right); }
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::hadamard(Node left, Node right) { return binary(OP_HADAMARD, left, right); }
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::addLines(Node value, Node vector) { return broadcast(OP_ADD_LINES, value, vector); }
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::subLines(Node value, Node vector) { return broadcast(OP_SUB_LINES, value, vector); }
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::mulLines(Node value, Node vector) { return broadcast(OP_MUL_LINES, value, vector); }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::mul(Node value, T scalar) {
+        const _Node& m = get(value);
+        return push(OP_MUL, value.id, -1, scalar, m.ls, m.cs);
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::div(Node value, T scalar) {
+        const _Node& m = get(value);
+        return push(OP_DIV, value.id, -1, scalar, m.ls, m.cs);
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::norm(Node value) {
+        get(value);
+        return push(OP_NORM, value.id, -1, (T)0, 1, 1);
+    }
+
+    template <typename T>
+    typename Graph<T>::Node Graph<T>::sum(Node value) {
+        get(value);
+        return push(OP_SUM, value.id, -1, (T)0, 1, 1);
+    }
+
+    template <typename T>
+    void Graph<T>::output(Node node, DMat<T>& result) {
+        const _Node& n = get(node);
+        if (n.output || n.op == OP_INPUT) { throw std::invalid_argument("Node already has an output or is an input"); }
+        if (result.ls != n.ls || result.cs != n.cs) { throw std::invalid_argument("Output must have the size of the node"); }
+        if (result.layout() != LAYOUT_ROW_MAJOR && result.ls > 1 && result.cs > 1) { throw std::invalid_argument("Graph outputs must be row-major"); }
+        _nodes[node.id].output = &result;
+    }
+
+    template <typename T>
+    void Graph<T>::output(Node node, T& result) {
+        const _Node& n = get(node, true);
+        if (n.op != OP_NORM && n.op != OP_SUM) { throw std::invalid_argument("Only reductions can be written to a scalar"); }
+        _nodes[node.id].scalarOutput = &result;
+    }
+
+    template <typename T>
+    void Graph<T>::run() {
+        const int n = (int)_nodes.size();
+        _passes = 0;
+        _temporaries = 0;
+
+        // Find the values contributing to an output and count their uses, dead values are skipped entirely
+        std::vector<bool> live(n, false);
+        std::vector<int> uses(n, 0);
+        std::vector<int> consumer(n, -1);
+        for (int i = n - 1; i >= 0; i--) {
+            const _Node& nd = _nodes[i];
+            if (nd.output || nd.scalarOutput) {
+                live[i] = true;
+                uses[i]++;
+            }
+            if (!live[i]) { continue; }
+            for (int op : { nd.a, nd.b }) {
+                if (op < 0) { continue; }
+                live[op] = true;
+                uses[op]++;
+                consumer[op] = i;
+            }
+        }
+
+        // A value is fused into its consumer when it is only used as the first operand of an element-wise operation
+        // or reduction, otherwise it is stored
+        std::vector<bool> fused(n, false);
+        for (int i = 0; i < n; i++) {
+            if (!live[i] || _nodes[i].op == OP_INPUT || uses[i] != 1 || consumer[i] < 0) { continue; }
+            const _Node& c = _nodes[consumer[i]];
+            fused[i] = (c.op != OP_DOT && c.a == i);
+        }
+
+        // Locate the stored values, writing directly to the outputs when possible
+        std::vector<DMat<T>> temporaries(n);
+        std::vector<T*> stored(n, NULL);
+        for (int i = 0; i < n; i++) {
+            const _Node& nd = _nodes[i];
+            if (!live[i] || fused[i] || nd.op == OP_NORM || nd.op == OP_SUM) { continue; }
+            if (nd.op == OP_INPUT) { stored[i] = (T*)nd.input->data(); }
+            else if (nd.output) { stored[i] = nd.output->data(); }
+            else {
+                temporaries[i] = DMat<T>(nd.ls, nd.cs);
+                stored[i] = temporaries[i].data();
+                _temporaries++;
+            }
+        }
+
+        // Run one pass per stored value or reduction of a fused chain, in recording order so operands come first
+        for (int e = 0; e < n; e++) {
+            const _Node& last = _nodes[e];
+            if (!live[e] || fused[e] || last.op == OP_INPUT) { continue; }
+            const bool reduction = (last.op == OP_NORM || last.op == OP_SUM);
+
+            // Reductions of a computed stored value are done by the pass storing it, while its lines are in cache
+            if (reduction && stored[last.a] && _nodes[last.a].op != OP_INPUT) { continue; }
+            std::vector<int> reductions;
+            if (reduction) { reductions.push_back(e); }
+            else {
+                for (int r = e + 1; r < n; r++) {
+                    const Op op = _nodes[r].op;
+                    if (live[r] && (op == OP_NORM || op == OP_SUM) && _nodes[r].a == e) { reductions.push_back(r); }
+                }
+            }
+
+            // Walk back the chain of fused operations down to the dot product or stored value producing it
+            std::vector<int> chain;
+            int cur = reduction ? last.a : e;
+            while (true) {
+                const _Node& nd = _nodes[cur];
+                if (nd.op == OP_INPUT) { break; }
+                chain.push_back(cur);
+                if (nd.op == OP_DOT || !fused[nd.a]) { break; }
+                cur = nd.a;
+            }
+            std::reverse(chain.begin(), chain.end());
+            const int first = chain.empty() ? -1 : chain[0];
+            const bool product = (first >= 0 && _nodes[first].op == OP_DOT);
+            const T* source = product ? NULL : stored[(first >= 0) ? _nodes[first].a : cur];
+
+            const int ls = _nodes[cur].ls;
+            const int cs = _nodes[cur].cs;
+            const int is = product ? _nodes[_nodes[first].a].cs : 1;
+            const T* left = product ? stored[_nodes[first].a] : NULL;
+            const T* right = product ? stored[_nodes[first].b] : NULL;
+            T* const dest = reduction ? NULL : stored[e];
+            const int count = (int)reductions.size();
+            std::vector<T> partials((size_t)count*ls);
+
+            const int64_t work = (int64_t)cs*(is + (int64_t)chain.size());
+            const int minChunk = (int)std::max<int64_t>(1, LIA_GRAPH_MIN_WORK / std::max<int64_t>(1, work));
+            parallelFor(ls, minChunk, [&](int begin, int end) {
+                std::vector<T> buffer(dest ? 0 : cs);
+                for (int i = begin; i < end; i++) {
+                    T* line = dest ? &dest[i*cs] : buffer.data();
+
+                    // Produce the line
+                    if (product) {
+                        const T* l = &left[i*is];
+                        if (cs == 1) {
+                            T s = (T)0;
+                            for (int k = 0; k < is; k++) { s += l[k]*right[k]; }
+                            line[0] = s;
+                        }
+                        else {
+                            for (int j = 0; j < cs; j++) { line[j] = (T)0; }
+                            for (int k = 0; k < is; k++) {
+                                const T lk = l[k];
+                                const T* r = &right[k*cs];
+                                for (int j = 0; j < cs; j++) { line[j] += lk*r[j]; }
+                            }
+                        }
+                    }
+                    else if (line != &source[i*cs]) {
+                        for (int j = 0; j < cs; j++) { line[j] = source[i*cs + j]; }
+                    }
+
+                    // Apply the fused element-wise operations while the line is in cache
+                    for (int id : chain) {
+                        const _Node& nd = _nodes[id];
+                        const T* b = (nd.b >= 0) ? stored[nd.b] : NULL;
+                        const T s = nd.scalar;
+                        switch (nd.op) {
+                            case OP_ADD:        for (int j = 0; j < cs; j++) { line[j] += b[i*cs + j]; } break;
+                            case OP_SUB:        for (int j = 0; j < cs; j++) { line[j] -= b[i*cs + j]; } break;
+                            case OP_HADAMARD:   for (int j = 0; j < cs; j++) { line[j] *= b[i*cs + j]; } break;
+                            case OP_ADD_LINES:  for (int j = 0; j < cs; j++) { line[j] += b[j]; } break;
+                            case OP_SUB_LINES:  for (int j = 0; j < cs; j++) { line[j] -= b[j]; } break;
+                            case OP_MUL_LINES:  for (int j = 0; j < cs; j++) { line[j] *= b[j]; } break;
+                            case OP_MUL:        for (int j = 0; j < cs; j++) { line[j] *= s; } break;
+                            case OP_DIV:        for (int j = 0; j < cs; j++) { line[j] /= s; } break;
+                            default: break;
+                        }
+                    }
+
+                    // Reduce the line
+                    for (int r = 0; r < count; r++) {
+                        const bool squares = (_nodes[reductions[r]].op == OP_NORM);
+                        partials[(size_t)r*ls + i] = squares ? _reduceLine<true>(line, cs) : _reduceLine<false>(line, cs);
+                    }
+                }
+            });
+            _passes++;
+
+            // Sum the partial results of each line in order
+            for (int r = 0; r < count; r++) {
+                T acc = (T)0;
+                for (int i = 0; i < ls; i++) { acc += partials[(size_t)r*ls + i]; }
+                const _Node& nd = _nodes[reductions[r]];
+                if (nd.op == OP_NORM) {
+                    if constexpr (std::is_same_v<T, float>) { acc = sqrtf(acc); }
+                    else { acc = (T)sqrt(acc); }
+                }
+                if (nd.scalarOutput) { *nd.scalarOutput = acc; }
+            }
+        }
+    }
+
+    template class Graph<double>;
+    template class Graph<float>;
+}
\ No newline at end of file
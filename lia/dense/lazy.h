@@ -0,0 +1,148 @@
+#pragma once
+#include "dynamic.h"
+#include <vector>
+
+namespace lia {
+    /**
+     * Deferred sequence of dense operations. Operations are recorded into a graph and only computed by run, which
+     * fuses each chain of element-wise operations and reductions into the dot product or load producing its first
+     * operand. A chain is computed line by line while the line is in cache, so it takes a single pass over memory.
+     * Values without an output and a single use are never stored, values that don't contribute to an output are not
+     * computed at all. Inputs and outputs must be row-major and outputs must not alias inputs.
+    */
+    template <typename T>
+    class Graph {
+    public:
+        // Handle of a value recorded in the graph
+        struct Node {
+            int id;
+        };
+
+        /**
+         * Add an input matrix. It is read by reference when the graph runs and must stay alive until then.
+         * @param value Row-major matrix or vector.
+         * @return Node of the matrix.
+        */
+        Node input(const DMat<T>& value);
+
+        /**
+         * Record the dot product between two matrices, or a matrix and a vector.
+         * @param left Left-hand matrix.
+         * @param right Right-hand matrix or vector.
+         * @return Node of the product.
+        */
+        Node dot(Node left, Node right);
+
+        /**
+         * Record an element-wise addition, subtraction or multiplication of two matrices of the same size.
+         * @param left Left-hand matrix.
+         * @param right Right-hand matrix.
+         * @return Node of the result.
+        */
+        Node add(Node left, Node right);
+        Node sub(Node left, Node right);
+        Node hadamard(Node left, Node right);
+
+        /**
+         * Record the addition, subtraction or multiplication of a vector with one element per column to every line
+         * of a matrix, such as a bias.
+         * @param value Matrix to broadcast the vector over.
+         * @param vector Vector with one element per column.
+         * @return Node of the result.
+        */
+        Node addLines(Node value, Node vector);
+        Node subLines(Node value, Node vector);
+        Node mulLines(Node value, Node vector);
+
+        /**
+         * Record the multiplication or division of a matrix by a scalar.
+         * @param value Matrix to scale.
+         * @param scalar Scalar factor or divisor.
+         * @return Node of the result.
+        */
+        Node mul(Node value, T scalar);
+        Node div(Node value, T scalar);
+
+        /**
+         * Record the euclidian norm of all the elements of a matrix or the sum of all its elements. The lines are
+         * reduced one by one and summed in order, so the result doesn't depend on the number of threads.
+         * @param value Matrix to reduce.
+         * @return Node of the scalar result, which can only be used as an output.
+        */
+        Node norm(Node value);
+        Node sum(Node value);
+
+        /**
+         * Write a value to a matrix or scalar when the graph runs. Each node can have a single output.
+         * @param node Node of the value.
+         * @param result Row-major matrix of the same size, or scalar for the reductions.
+        */
+        void output(Node node, DMat<T>& result);
+        void output(Node node, T& result);
+
+        /**
+         * Compute all the outputs. Can be called again after changing the content of the inputs.
+        */
+        void run();
+
+        /**
+         * Get the number of passes over memory made by the last run, one per fused chain.
+         * @return Number of passes.
+        */
+        int passes() const { return _passes; }
+
+        /**
+         * Get the number of temporary matrices allocated by the last run.
+         * @return Number of temporaries.
+        */
+        int temporaries() const { return _temporaries; }
+
+    private:
+        enum Op {
+            OP_INPUT,
+            OP_DOT,
+            OP_ADD,
+            OP_SUB,
+            OP_HADAMARD,
+            OP_ADD_LINES,
+            OP_SUB_LINES,
+            OP_MUL_LINES,
+            OP_MUL,
+            OP_DIV,
+            OP_NORM,
+            OP_SUM
+        };
+
+        struct _Node {
+            Op op;
+            int a;
+            int b;
+            T scalar;
+            int ls;
+            int cs;
+            const DMat<T>* input;
+            DMat<T>* output;
+            T* scalarOutput;
+        };
+
+        // Check a node handle and return the node, matrix nodes only unless scalars are allowed
+        const _Node& get(Node node, bool allowScalar = false) const;
+
+        // Record a node and return its handle
+        Node push(Op op, int a, int b, T scalar, int ls, int cs);
+
+        // Record an element-wise operation between two matrices of the same size
+        Node binary(Op op, Node left, Node right);
+
+        // Record an operation between a matrix and a vector with one element per column
+        Node broadcast(Op op, Node value, Node vector);
+
+        std::vector<_Node> _nodes;
+        int _passes = 0;
+        int _temporaries = 0;
+    };
+
+    // Common graph types
+    using Graphd = Graph<double>;
+    using Graphf = Graph<float>;
+}
\ No newline at end of file
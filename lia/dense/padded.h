@@ -0,0 +1,282 @@
+#pragma once
+#include "static.h"
+
+namespace lia {
+    /**
+     * 3D vector padded to four lanes and aligned so that it can be loaded with a single SIMD instruction.
+     * The dead w lane is zeroed by the constructors and ignored by the dot and cross products, norm and normalization.
+    */
+    template <typename T>
+    class alignas(4*sizeof(T)) PVec3 : public _XYZW<T> {
+    public:
+        // Default constructor
+        constexpr LIA_FORCE_INLINE PVec3() {
+            _XYZW<T>::data[3] = 0;
+        }
+
+        /**
+         * Create a vector and set its elements.
+         * @param x First element.
+         * @param y Second element.
+         * @param z Third element.
+        */
+        constexpr LIA_FORCE_INLINE PVec3(T x, T y, T z) {
+            _XYZW<T>::data[0] = x;
+            _XYZW<T>::data[1] = y;
+            _XYZW<T>::data[2] = z;
+            _XYZW<T>::data[3] = 0;
+        }
+
+        /**
+         * Create a padded vector from a packed one.
+         * @param value Packed vector.
+        */
+        constexpr LIA_FORCE_INLINE PVec3(const SVec<3, T>& value) : PVec3(value[0], value[1], value[2]) {}
+
+        // Conversion operator to a packed vector
+        constexpr LIA_FORCE_INLINE operator SVec<3, T>() const {
+            return SVec<3, T>(_XYZW<T>::data[0], _XYZW<T>::data[1], _XYZW<T>::data[2]);
+        }
+
+        // Array operator to access the data
+        constexpr LIA_FORCE_INLINE T& operator[](int id) { return _XYZW<T>::data[id]; }
+        constexpr LIA_FORCE_INLINE const T& operator[](int id) const { return _XYZW<T>::data[id]; }
+    };
+
+    // Common padded vector types
+    using PVec3d = PVec3<double>;
+    using PVec3f = PVec3<float>;
+
+#ifdef LIA_STATIC_SSE
+    // Clear the dead lane of a padded single-precision vector
+    static LIA_FORCE_INLINE __m128 _maskW(__m128 v) {
+        return _mm_and_ps(v, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+    }
+
+    // Dot product of two padded single-precision vectors broadcast to all lanes
+    static LIA_FORCE_INLINE __m128 _dot3(__m128 a, __m128 b) {
+        __m128 v = _maskW(_mm_mul_ps(a, b));
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    // Cross product of two padded single-precision vectors
+    static LIA_FORCE_INLINE __m128 _cross3(__m128 a, __m128 b) {
+        const __m128 ayzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 byzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 c = _mm_sub_ps(_mm_mul_ps(a, byzx), _mm_mul_ps(ayzx, b));
+        return _maskW(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+    }
+#endif
+
+    // ================================ PACKING ================================
+
+    /**
+     * Convert an array of packed vectors to padded vectors.
+     * @param results Padded vectors to write the results to.
+     * @param values Packed vectors to convert.
+     * @param count Number of vectors.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void pad(PVec3<T>* results, const SVec<3, T>* values, int count) {
+        for (int i = 0; i < count; i++) {
+            results[i] = PVec3<T>(values[i]);
+        }
+    }
+
+    /**
+     * Convert an array of padded vectors to packed vectors.
+     * @param results Packed vectors to write the results to.
+     * @param values Padded vectors to convert.
+     * @param count Number of vectors.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void pack(SVec<3, T>* results, const PVec3<T>* values, int count) {
+        for (int i = 0; i < count; i++) {
+            results[i] = (SVec<3, T>)values[i];
+        }
+    }
+
+    // ======================== ADDITION AND SUBTRACTION ========================
+
+    /**
+     * Add two padded vectors.
+     * @param result Vector to write the result to.
+     * @param left Left-hand vector.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void add(PVec3<T>& result, const PVec3<T>& left, const PVec3<T>& right) {
+        _staticFor<4>([&](auto i) { result.data[i] = left.data[i] + right.data[i]; });
+    }
+
+    // Addition operator for padded vectors
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE PVec3<T> operator+(const PVec3<T>& left, const PVec3<T>& right) {
+        PVec3<T> result;
+        add(result, left, right);
+        return result;
+    }
+
+    /**
+     * Subtract two padded vectors.
+     * @param result Vector to write the result to.
+     * @param left Left-hand vector.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void sub(PVec3<T>& result, const PVec3<T>& left, const PVec3<T>& right) {
+        _staticFor<4>([&](auto i) { result.data[i] = left.data[i] - right.data[i]; });
+    }
+
+    // Subtraction operator for padded vectors
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE PVec3<T> operator-(const PVec3<T>& left, const PVec3<T>& right) {
+        PVec3<T> result;
+        sub(result, left, right);
+        return result;
+    }
+
+    // ============================== DOT PRODUCT ==============================
+
+    /**
+     * Take the dot product between two padded vectors.
+     * @param result Scalar to write the result to.
+     * @param left Left-hand vector.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void dot(T& result, const PVec3<T>& left, const PVec3<T>& right) {
+#ifdef LIA_STATIC_SSE
+        if constexpr (std::is_same_v<T, float>) {
+            if (!_constantEvaluated()) {
+                result = _mm_cvtss_f32(_dot3(_mm_load_ps(left.data), _mm_load_ps(right.data)));
+                return;
+            }
+        }
+#endif
+        const T* a = left.data;
+        const T* b = right.data;
+        result = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    }
+
+    // Dot product operator for padded vectors
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE T operator*(const PVec3<T>& left, const PVec3<T>& right) {
+        T result = 0;
+        dot(result, left, right);
+        return result;
+    }
+
+    /**
+     * Take the dot products between arrays of padded vectors.
+     * @param results Scalars to write the results to.
+     * @param lefts Left-hand vectors.
+     * @param rights Right-hand vectors.
+     * @param count Number of vectors.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void dot(T* results, const PVec3<T>* lefts, const PVec3<T>* rights, int count) {
+        for (int i = 0; i < count; i++) {
+            dot(results[i], lefts[i], rights[i]);
+        }
+    }
+
+    // ============================= CROSS PRODUCT =============================
+
+    /**
+     * Take the cross product between two padded vectors.
+     * @param result Vector to write the result to.
+     * @param left Left-hand vector.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void cross(PVec3<T>& result, const PVec3<T>& left, const PVec3<T>& right) {
+#ifdef LIA_STATIC_SSE
+        if constexpr (std::is_same_v<T, float>) {
+            if (!_constantEvaluated()) {
+                _mm_store_ps(result.data, _cross3(_mm_load_ps(left.data), _mm_load_ps(right.data)));
+                return;
+            }
+        }
+#endif
+        const T* a = left.data;
+        const T* b = right.data;
+        const T x = a[1]*b[2] - a[2]*b[1];
+        const T y = a[2]*b[0] - a[0]*b[2];
+        const T z = a[0]*b[1] - a[1]*b[0];
+        T* r = result.data;
+        r[0] = x; r[1] = y; r[2] = z; r[3] = 0;
+    }
+
+    // Cross product operator for padded vectors
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE PVec3<T> operator^(const PVec3<T>& left, const PVec3<T>& right) {
+        PVec3<T> result;
+        cross(result, left, right);
+        return result;
+    }
+
+    /**
+     * Take the cross products between arrays of padded vectors.
+     * @param results Vectors to write the results to.
+     * @param lefts Left-hand vectors.
+     * @param rights Right-hand vectors.
+     * @param count Number of vectors.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void cross(PVec3<T>* results, const PVec3<T>* lefts, const PVec3<T>* rights, int count) {
+        for (int i = 0; i < count; i++) {
+            cross(results[i], lefts[i], rights[i]);
+        }
+    }
+
+    // ================================= NORM =================================
+
+    /**
+     * Compute the euclidian norm of a padded vector.
+     * @param value Vector to take the euclidian norm of.
+     * @return Euclidian norm of the vector.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE T norm(const PVec3<T>& value) {
+        if constexpr (std::is_same_v<T, float>) {
+            return sqrtf(value * value);
+        }
+        else {
+            return sqrt(value * value);
+        }
+    }
+
+    /**
+     * Scale a padded vector to unit norm.
+     * @param result Vector to write the result to.
+     * @param value Vector to normalize.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void normalize(PVec3<T>& result, const PVec3<T>& value) {
+#ifdef LIA_STATIC_SSE
+        if constexpr (std::is_same_v<T, float>) {
+            const __m128 v = _maskW(_mm_load_ps(value.data));
+            _mm_store_ps(result.data, _mm_div_ps(v, _mm_sqrt_ps(_dot3(v, v))));
+            return;
+        }
+#endif
+        const T n = norm(value);
+        _staticFor<3>([&](auto i) { result.data[i] = value.data[i] / n; });
+        result.data[3] = 0;
+    }
+
+    /**
+     * Scale an array of padded vectors to unit norm.
+     * @param results Vectors to write the results to.
+     * @param values Vectors to normalize.
+     * @param count Number of vectors.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void normalize(PVec3<T>* results, const PVec3<T>* values, int count) {
+        for (int i = 0; i < count; i++) {
+            normalize(results[i], values[i]);
+        }
+    }
+}
\ No newline at end of file
@@ -1,8 +1,24 @@
 #pragma once
 #include <initializer_list>
 #include <variant>
+#include <type_traits>
+#include <utility>
+#include <string.h>
+#include <math.h>
+#include <float.h>
 #include "../force_inline.h"
 
+// SSE kernels for single-precision vectors, can be disabled by defining LIA_STATIC_NO_SIMD
+#if !defined(LIA_STATIC_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define LIA_STATIC_SSE
+#include <xmmintrin.h>
+#endif
+
+// Largest number of elements for which the generic static kernels are fully unrolled (8x8 by default)
+#ifndef LIA_SMAT_UNROLL_MAX
+#define LIA_SMAT_UNROLL_MAX 64
+#endif
+
 namespace lia {
     template <typename T>
     struct _XY {
@@ -235,6 +251,59 @@ namespace lia {
     using Mat3i = SMati<3, 3>;
     using Mat4i = SMati<4, 4>;
 
+    // ================================ UNROLLING ================================
+
+    template <class F, int... I>
+    static constexpr LIA_FORCE_INLINE void _unroll(F&& f, std::integer_sequence<int, I...>) {
+        (f(std::integral_constant<int, I>()), ...);
+    }
+
+    template <typename T, class F, int... I>
+    static constexpr LIA_FORCE_INLINE T _unrollSum(F&& f, std::integer_sequence<int, I...>) {
+        return ((T)0 + ... + f(std::integral_constant<int, I>()));
+    }
+
+    // Call a function for each index of a range, fully unrolled at compile time if requested
+    template <int count, bool unroll = (count <= LIA_SMAT_UNROLL_MAX), class F>
+    static constexpr LIA_FORCE_INLINE void _staticFor(F&& f) {
+        if constexpr (unroll) {
+            _unroll(f, std::make_integer_sequence<int, count>());
+        }
+        else {
+            for (int i = 0; i < count; i++) { f(i); }
+        }
+    }
+
+    // Sum a function over each index of a range in increasing order, fully unrolled at compile time if requested
+    template <typename T, int count, bool unroll = (count <= LIA_SMAT_UNROLL_MAX), class F>
+    static constexpr LIA_FORCE_INLINE T _staticSum(F&& f) {
+        if constexpr (unroll) {
+            return _unrollSum<T>(f, std::make_integer_sequence<int, count>());
+        }
+        else {
+            T sum = 0;
+            for (int i = 0; i < count; i++) { sum += f(i); }
+            return sum;
+        }
+    }
+
+    // ================================== SIMD ==================================
+
+    // Whether the code is being evaluated at compile time, in which case intrinsics can't be used
+    static constexpr LIA_FORCE_INLINE bool _constantEvaluated() {
+        return __builtin_is_constant_evaluated();
+    }
+
+#ifdef LIA_STATIC_SSE
+    // Sum the four lanes of an SSE register
+    static LIA_FORCE_INLINE float _hsum(__m128 v) {
+        __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        const __m128 sums = _mm_add_ps(v, shuf);
+        shuf = _mm_movehl_ps(shuf, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+    }
+#endif
+
     // ================================= CAST =================================
 
     /**
@@ -274,9 +343,7 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void cast(SVec<d, TB>& result, const SVec<d, TA>& value) {
         const TA* a = value.data;
         TB* r = result.data;
-        for (int i = 0; i < d; i++) {
-            r[i] = (TB)a[i];
-        }
+        _staticFor<d>([&](auto i) { r[i] = (TB)a[i]; });
     }
 
     template <typename TA, typename TB>
@@ -310,9 +377,7 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void cast(SMat<ls, cs, TB>& result, const SMat<ls, cs, TA>& value) {
         const TA* a = value.data;
         TB* r = result.data;
-        for (int i = 0; i < ls*cs; i++) {
-            r[i] = (TB)a[i];
-        }
+        _staticFor<ls*cs>([&](auto i) { r[i] = (TB)a[i]; });
     }
 
     // ================================= CLEAR =================================
@@ -350,9 +415,7 @@ namespace lia {
     template <int d, typename T>
     static constexpr LIA_FORCE_INLINE void clear(SVec<d, T>& result, const T& value = 0.0) {
         T* r = result.data;
-        for (int i = 0; i < d; i++) {
-            r[i] = value;
-        }
+        _staticFor<d>([&](auto i) { r[i] = value; });
     }
 
     template <typename T>
@@ -382,9 +445,7 @@ namespace lia {
     template <int ls, int cs, typename T>
     static constexpr LIA_FORCE_INLINE void clear(SMat<ls, cs, T>& result, const T& value = 0.0) {
         T* r = result.data;
-        for (int i = 0; i < ls*cs; i++) {
-            r[i] = value;
-        }
+        _staticFor<ls*cs>([&](auto i) { r[i] = value; });
     }
 
     // =============================== TRANSPOSE ===============================
@@ -458,16 +519,20 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void transpose(SMat<cs, ls, T>& result, const SMat<ls, cs, T>& value) {
         const T* v = value.data;
         T* r = result.data;
-        for (int i = 0; i < ls; i++) {
-            const T* line = &v[i*cs];
-            for (int j = 0; j < cs; j++) {
-                r[j*ls + i] = line[j];
-            }
-        }
+        constexpr bool unroll = (ls*cs <= LIA_SMAT_UNROLL_MAX);
+        _staticFor<ls, unroll>([&](auto i) {
+            _staticFor<cs, unroll>([&](auto j) { r[j*ls + i] = v[i*cs + j]; });
+        });
     }
 
     // ================================= NORM =================================
 
+    // Square root in the precision of the element type
+    template <typename T>
+    static LIA_FORCE_INLINE T _sqrt(T value) {
+        if constexpr (std::is_same_v<T, float>) { return sqrtf(value); } else { return (T)sqrt(value); }
+    }
+
     /**
      * Compute the euclidian norm of a vector.
      * @param value Vector to take the euclidian norm of.
@@ -510,10 +575,7 @@ namespace lia {
     template <int d, typename T>
     static LIA_FORCE_INLINE T norm(const SVec<d, T>& value) {
         const T* v = value.data;
-        T sum = 0.0;
-        for (int i = 0; i < d; i++) {
-            sum += v[i]*v[i];
-        }
+        const T sum = _staticSum<T, d>([&](auto i) { return v[i]*v[i]; });
         if constexpr (std::is_same_v<T, float>) {
             return sqrtf(sum);
         }
@@ -522,6 +584,171 @@ namespace lia {
         }
     }
 
+    /**
+     * Compute the reciprocal square root of a value.
+     * @param value Value to take the reciprocal square root of.
+     * @return Reciprocal square root of the value.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE T rsqrt(T value) {
+        return (T)1 / _sqrt<T>(value);
+    }
+
+#ifdef LIA_STATIC_SSE
+    // Approximate reciprocal square root refined by one Newton-Raphson step, y' = y*(1.5 - 0.5*x*y*y)
+    static LIA_FORCE_INLINE __m128 _rsqrtFast(__m128 x) {
+        // The rsqrt instruction flushes subnormals to zero, scale them by 2^64 and the result back by 2^32
+        const __m128 tiny = _mm_cmplt_ps(x, _mm_set1_ps(FLT_MIN));
+        const __m128 xs = _mm_or_ps(_mm_and_ps(tiny, _mm_mul_ps(x, _mm_set1_ps(18446744073709551616.0f))), _mm_andnot_ps(tiny, x));
+        const __m128 scale = _mm_or_ps(_mm_and_ps(tiny, _mm_set1_ps(4294967296.0f)), _mm_andnot_ps(tiny, _mm_set1_ps(1.0f)));
+
+        const __m128 y = _mm_rsqrt_ps(xs);
+        const __m128 hxyy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), xs), _mm_mul_ps(y, y));
+        const __m128 refined = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), hxyy));
+
+        // The refinement turns the exact estimates for zero and infinity into NaNs, keep the estimate in that case
+        const __m128 exact = _mm_or_ps(_mm_cmpeq_ps(xs, _mm_setzero_ps()), _mm_cmpeq_ps(xs, _mm_set1_ps(INFINITY)));
+        return _mm_mul_ps(_mm_or_ps(_mm_and_ps(exact, y), _mm_andnot_ps(exact, refined)), scale);
+    }
+#endif
+
+    /**
+     * Approximate the reciprocal square root of a value using the rsqrt instruction refined by one Newton-Raphson
+     * step. The relative error stays below 1e-6 (instead of half an ulp), including for subnormals, and zero and
+     * infinity give infinity and zero like the exact version.
+     * Falls back to the exact computation when SSE isn't available.
+     * @param value Value to take the reciprocal square root of.
+     * @return Approximate reciprocal square root of the value.
+    */
+    static LIA_FORCE_INLINE float rsqrtFast(float value) {
+#ifdef LIA_STATIC_SSE
+        return _mm_cvtss_f32(_rsqrtFast(_mm_set_ss(value)));
+#else
+        return 1.0f / sqrtf(value);
+#endif
+    }
+
+    /**
+     * Scale a vector to unit norm.
+     * @param result Vector to write the result to.
+     * @param value Vector to normalize.
+    */
+    template <int d, typename T>
+    static LIA_FORCE_INLINE void normalize(SVec<d, T>& result, const SVec<d, T>& value) {
+        const T* v = value.data;
+        T* r = result.data;
+        const T inv = rsqrt(_staticSum<T, d>([&](auto i) { return v[i]*v[i]; }));
+        _staticFor<d>([&](auto i) { r[i] = v[i]*inv; });
+    }
+
+    /**
+     * Scale a single-precision vector to approximately unit norm using rsqrtFast.
+     * @param result Vector to write the result to.
+     * @param value Vector to normalize.
+    */
+    template <int d>
+    static LIA_FORCE_INLINE void normalizeFast(SVec<d, float>& result, const SVec<d, float>& value) {
+        const float* v = value.data;
+        float* r = result.data;
+        const float inv = rsqrtFast(_staticSum<float, d>([&](auto i) { return v[i]*v[i]; }));
+        _staticFor<d>([&](auto i) { r[i] = v[i]*inv; });
+    }
+
+    /**
+     * Scale an array of vectors to unit norm.
+     * @param results Vectors to write the results to.
+     * @param values Vectors to normalize.
+     * @param count Number of vectors.
+    */
+    template <int d, typename T>
+    static LIA_FORCE_INLINE void normalize(SVec<d, T>* results, const SVec<d, T>* values, int count) {
+        for (int i = 0; i < count; i++) {
+            normalize(results[i], values[i]);
+        }
+    }
+
+    /**
+     * Scale an array of single-precision vectors to approximately unit norm, computing the reciprocal square roots
+     * of four vectors at once.
+     * @param results Vectors to write the results to.
+     * @param values Vectors to normalize.
+     * @param count Number of vectors.
+    */
+    template <int d>
+    static LIA_FORCE_INLINE void normalizeFast(SVec<d, float>* results, const SVec<d, float>* values, int count) {
+        int i = 0;
+#ifdef LIA_STATIC_SSE
+        alignas(16) float inv[4];
+        for (; i + 4 <= count; i += 4) {
+            _staticFor<4>([&](auto n) {
+                const float* v = values[i + n].data;
+                inv[n] = _staticSum<float, d>([&](auto k) { return v[k]*v[k]; });
+            });
+            _mm_store_ps(inv, _rsqrtFast(_mm_load_ps(inv)));
+            _staticFor<4>([&](auto n) {
+                _staticFor<d>([&](auto k) { results[i + n].data[k] = values[i + n].data[k]*inv[n]; });
+            });
+        }
+#endif
+        for (; i < count; i++) {
+            normalizeFast(results[i], values[i]);
+        }
+    }
+
+    // =============================== DISTANCE ===============================
+
+    /**
+     * Compute the squared euclidian distance between two vectors.
+     * @param left First vector.
+     * @param right Second vector.
+     * @return Squared euclidian distance between the vectors.
+    */
+    template <int d, typename T>
+    static constexpr LIA_FORCE_INLINE T distance2(const SVec<d, T>& left, const SVec<d, T>& right) {
+        const T* a = left.data;
+        const T* b = right.data;
+        return _staticSum<T, d>([&](auto i) { return (a[i] - b[i])*(a[i] - b[i]); });
+    }
+
+    /**
+     * Compute the euclidian distance between two vectors.
+     * @param left First vector.
+     * @param right Second vector.
+     * @return Euclidian distance between the vectors.
+    */
+    template <int d, typename T>
+    static LIA_FORCE_INLINE T distance(const SVec<d, T>& left, const SVec<d, T>& right) {
+        return _sqrt<T>(distance2(left, right));
+    }
+
+    /**
+     * Compute the squared euclidian distances between arrays of vectors.
+     * @param results Scalars to write the results to.
+     * @param lefts First vectors.
+     * @param rights Second vectors.
+     * @param count Number of vectors.
+    */
+    template <int d, typename T>
+    static LIA_FORCE_INLINE void distance2(T* results, const SVec<d, T>* lefts, const SVec<d, T>* rights, int count) {
+        for (int i = 0; i < count; i++) {
+            results[i] = distance2(lefts[i], rights[i]);
+        }
+    }
+
+    /**
+     * Compute the euclidian distances between arrays of vectors.
+     * @param results Scalars to write the results to.
+     * @param lefts First vectors.
+     * @param rights Second vectors.
+     * @param count Number of vectors.
+    */
+    template <int d, typename T>
+    static LIA_FORCE_INLINE void distance(T* results, const SVec<d, T>* lefts, const SVec<d, T>* rights, int count) {
+        for (int i = 0; i < count; i++) {
+            results[i] = distance(lefts[i], rights[i]);
+        }
+    }
+
     // =============================== ADDITION ===============================
 
     /**
@@ -566,9 +793,7 @@ namespace lia {
         const T* a = left.data;
         const T* b = right.data;
         T* r = result.data;
-        for (int i = 0; i < d; i++) {
-            r[i] = a[i] + b[i];
-        }
+        _staticFor<d>([&](auto i) { r[i] = a[i] + b[i]; });
     }
 
     template <typename T>
@@ -606,9 +831,7 @@ namespace lia {
         const T* a = left.data;
         const T* b = right.data;
         T* r = result.data;
-        for (int i = 0; i < ls*cs; i++) {
-            r[i] = a[i] + b[i];
-        }
+        _staticFor<ls*cs>([&](auto i) { r[i] = a[i] + b[i]; });
     }
 
     // Addition operator for static matrices and vectors
@@ -663,9 +886,7 @@ namespace lia {
         const T* a = left.data;
         const T* b = right.data;
         T* r = result.data;
-        for (int i = 0; i < d; i++) {
-            r[i] = a[i] - b[i];
-        }
+        _staticFor<d>([&](auto i) { r[i] = a[i] - b[i]; });
     }
 
     template <typename T>
@@ -703,9 +924,7 @@ namespace lia {
         const T* a = left.data;
         const T* b = right.data;
         T* r = result.data;
-        for (int i = 0; i < ls*cs; i++) {
-            r[i] = a[i] - b[i];
-        }
+        _staticFor<ls*cs>([&](auto i) { r[i] = a[i] - b[i]; });
     }
 
     // Addition operator for static matrices and vectors
@@ -756,9 +975,7 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void mul(SVec<d, T>& result, const SVec<d, T>& value, const T& scalar) {
         const T* v = value.data;
         T* r = result.data;
-        for (int i = 0; i < d; i++) {
-            r[i] = v[i] * scalar;
-        }
+        _staticFor<d>([&](auto i) { r[i] = v[i] * scalar; });
     }
 
     template <typename T>
@@ -792,9 +1009,7 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void mul(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& value, const T& scalar) {
         const T* m = value.data;
         T* r = result.data;
-        for (int i = 0; i < ls*cs; i++) {
-            r[i] = m[i] * scalar;
-        }
+        _staticFor<ls*cs>([&](auto i) { r[i] = m[i] * scalar; });
     }
 
     // Scalar multiplication operator (scalar on the right)
@@ -853,9 +1068,7 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void div(SVec<d, T>& result, const SVec<d, T>& left, const T& right) {
         const T* a = left.data;
         T* r = result.data;
-        for (int i = 0; i < d; i++) {
-            r[i] = a[i] / (T)right;
-        }
+        _staticFor<d>([&](auto i) { r[i] = a[i] / (T)right; });
     }
 
     template <typename T>
@@ -889,9 +1102,7 @@ namespace lia {
     static constexpr LIA_FORCE_INLINE void div(SMat<ls, cs, T>& result, const SMat<ls, cs, T>& left, const T& right) {
         const T* a = left.data;
         T* r = result.data;
-        for (int i = 0; i < ls*cs; i++) {
-            r[i] = a[i] / (T)right;
-        }
+        _staticFor<ls*cs>([&](auto i) { r[i] = a[i] / (T)right; });
     }
 
     // Scalar division operator
@@ -912,34 +1123,39 @@ namespace lia {
     */
 
     template <typename T>
-    static constexpr LIA_FORCE_INLINE void dot(double& result, const SVec<2, T>& left, const SVec<2, T>& right) {
+    static constexpr LIA_FORCE_INLINE void dot(T& result, const SVec<2, T>& left, const SVec<2, T>& right) {
         const T* a = left.data;
         const T* b = right.data;
         result = a[0]*b[0] + a[1]*b[1];
     }
 
     template <typename T>
-    static constexpr LIA_FORCE_INLINE void dot(double& result, const SVec<3, T>& left, const SVec<3, T>& right) {
+    static constexpr LIA_FORCE_INLINE void dot(T& result, const SVec<3, T>& left, const SVec<3, T>& right) {
         const T* a = left.data;
         const T* b = right.data;
         result = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
     }
 
     template <typename T>
-    static constexpr LIA_FORCE_INLINE void dot(double& result, const SVec<4, T>& left, const SVec<4, T>& right) {
+    static constexpr LIA_FORCE_INLINE void dot(T& result, const SVec<4, T>& left, const SVec<4, T>& right) {
         const T* a = left.data;
         const T* b = right.data;
+#ifdef LIA_STATIC_SSE
+        if constexpr (std::is_same_v<T, float>) {
+            if (!_constantEvaluated()) {
+                result = _hsum(_mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+                return;
+            }
+        }
+#endif
         result = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
     }
 
     template <int d, typename T>
-    static constexpr LIA_FORCE_INLINE void dot(double& result, const SVec<d, T>& left, const SVec<d, T>& right) {
+    static constexpr LIA_FORCE_INLINE void dot(T& result, const SVec<d, T>& left, const SVec<d, T>& right) {
         const T* a = left.data;
         const T* b = right.data;
-        result = 0.0;
-        for (int i = 0; i < d; i++) {
-            result += a[i]*b[i];
-        }
+        result = _staticSum<T, d>([&](auto i) { return a[i]*b[i]; });
     }
 
     template <typename T>
@@ -972,19 +1188,15 @@ namespace lia {
         r[3] = a[12]*b[0] + a[13]*b[1] + a[14]*b[2] + a[15]*b[3];
     }
 
-    template <int d, typename T>
-    static constexpr LIA_FORCE_INLINE void dot(SVec<d, T>& result, const SMat<d, d, T>& left, const SVec<d, T>& right) {
+    template <int a, int b, typename T>
+    static constexpr LIA_FORCE_INLINE void dot(SVec<a, T>& result, const SMat<a, b, T>& left, const SVec<b, T>& right) {
         const T* da = left.data;
         const T* db = right.data;
         T* r = result.data;
-        for (int i = 0; i < d; i++) {
-            const T* line = &da[i*d];
-            T* const sum = &r[i];
-            *sum = 0;
-            for (int j = 0; j < d; j++) {
-                *sum += line[j]*db[j];
-            }
-        }
+        constexpr bool unroll = (a*b <= LIA_SMAT_UNROLL_MAX);
+        _staticFor<a, unroll>([&](auto i) {
+            r[i] = _staticSum<T, b, unroll>([&](auto j) { return da[i*b + j]*db[j]; });
+        });
     }
 
     template <typename T>
@@ -1022,15 +1234,34 @@ namespace lia {
         const T* da = left.data;
         const T* db = right.data;
         T* r = result.data;
-        for (int i = 0; i < a; i++) {
-            const T* line = &da[i*b];
-            for (int j = 0; j < c; j++) {
-                const T* col = &db[j];
-                T* const sum = &r[i*c + j];
-                *sum = 0;
-                for (int k = 0; k < b; k++) {
-                    *sum += line[k] * (*col);
-                    col += c;
+        constexpr bool unroll = (a*b <= LIA_SMAT_UNROLL_MAX && b*c <= LIA_SMAT_UNROLL_MAX && a*c <= LIA_SMAT_UNROLL_MAX);
+        if constexpr (unroll && c == 1) {
+            _staticFor<a, true>([&](auto i) {
+                r[i] = _staticSum<T, b, true>([&](auto k) { return da[i*b + k]*db[k]; });
+            });
+        }
+        else if constexpr (unroll) {
+            // Accumulate each line of the result over the contiguous lines of the right-hand matrix
+            _staticFor<a, true>([&](auto i) {
+                T line[c];
+                _staticFor<c, true>([&](auto j) { line[j] = da[i*b]*db[j]; });
+                _staticFor<b - 1, true>([&](auto k) {
+                    _staticFor<c, true>([&](auto j) { line[j] += da[i*b + k + 1]*db[(k + 1)*c + j]; });
+                });
+                _staticFor<c, true>([&](auto j) { r[i*c + j] = line[j]; });
+            });
+        }
+        else {
+            for (int i = 0; i < a; i++) {
+                const T* line = &da[i*b];
+                for (int j = 0; j < c; j++) {
+                    const T* col = &db[j];
+                    T* const sum = &r[i*c + j];
+                    *sum = 0;
+                    for (int k = 0; k < b; k++) {
+                        *sum += line[k] * (*col);
+                        col += c;
+                    }
                 }
             }
         }
@@ -1039,7 +1270,7 @@ namespace lia {
     // Vector dot product operator
     template <int d, typename T>
     static constexpr LIA_FORCE_INLINE T operator*(const SVec<d, T>& left, const SVec<d, T>& right) {
-        T result;
+        T result = 0;
         dot(result, left, right);
         return result;
     }
@@ -0,0 +1,360 @@
+#include "structured.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace lia {
+    // Check that a dense matrix is row-major or a vector since the kernels walk its lines contiguously
+    template <typename T>
+    static LIA_FORCE_INLINE void _checkRowMajor(const DMat<T>& value) {
+        if (value.layout() != LAYOUT_ROW_MAJOR && value.ls > 1 && value.cs > 1) { throw std::invalid_argument("Dense operands must be row-major"); }
+    }
+
+    template <typename T>
+    void toMat(DMat<T>& result, const SymMat<T>& value) {
+        const int n = value.n;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) { result(i, j) = value(i, j); }
+        }
+    }
+    template void toMat(DMat<double>& result, const SymMat<double>& value);
+    template void toMat(DMat<float>& result, const SymMat<float>& value);
+
+    template <typename T>
+    void toMat(DMat<T>& result, const TriMat<T>& value) {
+        const int n = value.n;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) { result(i, j) = value.get(i, j); }
+        }
+    }
+    template void toMat(DMat<double>& result, const TriMat<double>& value);
+    template void toMat(DMat<float>& result, const TriMat<float>& value);
+
+    template <typename T>
+    void toMat(DMat<T>& result, const BandMat<T>& value) {
+        const int n = value.n;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) { result(i, j) = value.get(i, j); }
+        }
+    }
+    template void toMat(DMat<double>& result, const BandMat<double>& value);
+    template void toMat(DMat<float>& result, const BandMat<float>& value);
+
+    template <typename T>
+    void fromMat(SymMat<T>& result, const DMat<T>& value) {
+        const int n = result.n;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j <= i; j++) { result(i, j) = value(i, j); }
+        }
+    }
+    template void fromMat(SymMat<double>& result, const DMat<double>& value);
+    template void fromMat(SymMat<float>& result, const DMat<float>& value);
+
+    template <typename T>
+    void fromMat(TriMat<T>& result, const DMat<T>& value) {
+        const int n = result.n;
+        const bool lower = (result.uplo == UPLO_LOWER);
+        for (int i = 0; i < n; i++) {
+            const int begin = lower ? 0 : i;
+            const int end = lower ? i + 1 : n;
+            for (int j = begin; j < end; j++) { result(i, j) = value(i, j); }
+        }
+    }
+    template void fromMat(TriMat<double>& result, const DMat<double>& value);
+    template void fromMat(TriMat<float>& result, const DMat<float>& value);
+
+    template <typename T>
+    void fromMat(BandMat<T>& result, const DMat<T>& value) {
+        const int n = result.n;
+        for (int i = 0; i < n; i++) {
+            const int begin = std::max(0, i - result.kl);
+            const int end = std::min(n, i + result.ku + 1);
+            for (int j = begin; j < end; j++) { result(i, j) = value(i, j); }
+        }
+    }
+    template void fromMat(BandMat<double>& result, const DMat<double>& value);
+    template void fromMat(BandMat<float>& result, const DMat<float>& value);
+
+    template <typename T>
+    void dot(DVec<T>& result, const SymMat<T>& left, const DVec<T>& right) {
+        const T* x = right.data();
+        T* r = result.data();
+        const int n = left.n;
+        for (int i = 0; i < n; i++) { r[i] = 0; }
+
+        // Each stored element below the diagonal contributes to both of its mirrored positions
+        for (int i = 0; i < n; i++) {
+            const T* line = &left.data()[SymMat<T>::index(i, 0)];
+            const T xi = x[i];
+            T sum = 0;
+            for (int j = 0; j < i; j++) {
+                sum += line[j]*x[j];
+                r[j] += line[j]*xi;
+            }
+            r[i] += sum + line[i]*xi;
+        }
+    }
+    template void dot(DVec<double>& result, const SymMat<double>& left, const DVec<double>& right);
+    template void dot(DVec<float>& result, const SymMat<float>& left, const DVec<float>& right);
+
+    template <typename T>
+    void dot(DMat<T>& result, const SymMat<T>& left, const DMat<T>& right) {
+        _checkRowMajor(result);
+        _checkRowMajor(right);
+        const int n = left.n;
+        const int cs = right.cs;
+        const T* b = right.data();
+        T* r = result.data();
+        for (int64_t i = 0; i < (int64_t)n*cs; i++) { r[i] = 0; }
+        for (int i = 0; i < n; i++) {
+            const T* line = &left.data()[SymMat<T>::index(i, 0)];
+            T* const ri = &r[i*cs];
+            const T* const bi = &b[i*cs];
+            for (int j = 0; j < i; j++) {
+                const T a = line[j];
+                T* const rj = &r[j*cs];
+                const T* const bj = &b[j*cs];
+                for (int k = 0; k < cs; k++) {
+                    ri[k] += a*bj[k];
+                    rj[k] += a*bi[k];
+                }
+            }
+            const T a = line[i];
+            for (int k = 0; k < cs; k++) { ri[k] += a*bi[k]; }
+        }
+    }
+    template void dot(DMat<double>& result, const SymMat<double>& left, const DMat<double>& right);
+    template void dot(DMat<float>& result, const SymMat<float>& left, const DMat<float>& right);
+
+    template <typename T>
+    void dot(DVec<T>& result, const TriMat<T>& left, const DVec<T>& right) {
+        const T* x = right.data();
+        T* r = result.data();
+        const int n = left.n;
+        const bool lower = (left.uplo == UPLO_LOWER);
+        for (int i = 0; i < n; i++) {
+            const int begin = lower ? 0 : i;
+            const int end = lower ? i + 1 : n;
+            const T* line = &left.data()[left.index(i, begin)] - begin;
+            T sum = 0;
+            for (int j = begin; j < end; j++) { sum += line[j]*x[j]; }
+            r[i] = sum;
+        }
+    }
+    template void dot(DVec<double>& result, const TriMat<double>& left, const DVec<double>& right);
+    template void dot(DVec<float>& result, const TriMat<float>& left, const DVec<float>& right);
+
+    template <typename T>
+    void dot(DMat<T>& result, const TriMat<T>& left, const DMat<T>& right) {
+        _checkRowMajor(result);
+        _checkRowMajor(right);
+        const int n = left.n;
+        const int cs = right.cs;
+        const T* b = right.data();
+        T* r = result.data();
+        const bool lower = (left.uplo == UPLO_LOWER);
+        for (int i = 0; i < n; i++) {
+            const int begin = lower ? 0 : i;
+            const int end = lower ? i + 1 : n;
+            const T* line = &left.data()[left.index(i, begin)] - begin;
+            T* const ri = &r[i*cs];
+            for (int k = 0; k < cs; k++) { ri[k] = 0; }
+            for (int j = begin; j < end; j++) {
+                const T a = line[j];
+                const T* const bj = &b[j*cs];
+                for (int k = 0; k < cs; k++) { ri[k] += a*bj[k]; }
+            }
+        }
+    }
+    template void dot(DMat<double>& result, const TriMat<double>& left, const DMat<double>& right);
+    template void dot(DMat<float>& result, const TriMat<float>& left, const DMat<float>& right);
+
+    template <typename T>
+    void dot(DVec<T>& result, const BandMat<T>& left, const DVec<T>& right) {
+        const T* x = right.data();
+        T* r = result.data();
+        const int n = left.n;
+        for (int i = 0; i < n; i++) {
+            const int begin = std::max(0, i - left.kl);
+            const int end = std::min(n, i + left.ku + 1);
+            const T* line = &left.data()[left.index(i, 0)];
+            T sum = 0;
+            for (int j = begin; j < end; j++) { sum += line[j]*x[j]; }
+            r[i] = sum;
+        }
+    }
+    template void dot(DVec<double>& result, const BandMat<double>& left, const DVec<double>& right);
+    template void dot(DVec<float>& result, const BandMat<float>& left, const DVec<float>& right);
+
+    template <typename T>
+    void dot(DMat<T>& result, const BandMat<T>& left, const DMat<T>& right) {
+        _checkRowMajor(result);
+        _checkRowMajor(right);
+        const int n = left.n;
+        const int cs = right.cs;
+        const T* b = right.data();
+        T* r = result.data();
+        for (int i = 0; i < n; i++) {
+            const int begin = std::max(0, i - left.kl);
+            const int end = std::min(n, i + left.ku + 1);
+            const T* line = &left.data()[left.index(i, 0)];
+            T* const ri = &r[i*cs];
+            for (int k = 0; k < cs; k++) { ri[k] = 0; }
+            for (int j = begin; j < end; j++) {
+                const T a = line[j];
+                const T* const bj = &b[j*cs];
+                for (int k = 0; k < cs; k++) { ri[k] += a*bj[k]; }
+            }
+        }
+    }
+    template void dot(DMat<double>& result, const BandMat<double>& left, const DMat<double>& right);
+    template void dot(DMat<float>& result, const BandMat<float>& left, const DMat<float>& right);
+
+    template <typename T>
+    void syrk(SymMat<T>& result, const DMat<T>& value) {
+        _checkRowMajor(value);
+        const int n = value.ls;
+        const int cs = value.cs;
+        const T* a = value.data();
+        T* r = result.data();
+        for (int i = 0; i < n; i++) {
+            const T* const ai = &a[i*cs];
+            T* const line = &r[SymMat<T>::index(i, 0)];
+            for (int j = 0; j <= i; j++) {
+                const T* const aj = &a[j*cs];
+                T sum = 0;
+                for (int k = 0; k < cs; k++) { sum += ai[k]*aj[k]; }
+                line[j] = sum;
+            }
+        }
+    }
+    template void syrk(SymMat<double>& result, const DMat<double>& value);
+    template void syrk(SymMat<float>& result, const DMat<float>& value);
+
+    template <typename T>
+    void solve(DVec<T>& result, const TriMat<T>& left, const DVec<T>& right) {
+        const T* b = right.data();
+        T* x = result.data();
+        const int n = left.n;
+        if (left.uplo == UPLO_LOWER) {
+            for (int i = 0; i < n; i++) {
+                const T* line = &left.data()[left.index(i, 0)];
+                T sum = b[i];
+                for (int j = 0; j < i; j++) { sum -= line[j]*x[j]; }
+                x[i] = sum / line[i];
+            }
+        }
+        else {
+            for (int i = n - 1; i >= 0; i--) {
+                const T* line = &left.data()[left.index(i, i)] - i;
+                T sum = b[i];
+                for (int j = i + 1; j < n; j++) { sum -= line[j]*x[j]; }
+                x[i] = sum / line[i];
+            }
+        }
+    }
+    template void solve(DVec<double>& result, const TriMat<double>& left, const DVec<double>& right);
+    template void solve(DVec<float>& result, const TriMat<float>& left, const DVec<float>& right);
+
+    template <typename T>
+    void solve(DMat<T>& result, const TriMat<T>& left, const DMat<T>& right) {
+        _checkRowMajor(result);
+        _checkRowMajor(right);
+        const int n = left.n;
+        const int cs = right.cs;
+        const T* b = right.data();
+        T* x = result.data();
+        const bool lower = (left.uplo == UPLO_LOWER);
+
+        // Substitute whole lines at once so that the inner loop runs over contiguous columns
+        for (int s = 0; s < n; s++) {
+            const int i = lower ? s : n - 1 - s;
+            const int begin = lower ? 0 : i + 1;
+            const int end = lower ? i : n;
+            const T* line = &left.data()[left.index(i, i)] - i;
+            T* const xi = &x[i*cs];
+            for (int k = 0; k < cs; k++) { xi[k] = b[i*cs + k]; }
+            for (int j = begin; j < end; j++) {
+                const T a = line[j];
+                const T* const xj = &x[j*cs];
+                for (int k = 0; k < cs; k++) { xi[k] -= a*xj[k]; }
+            }
+            const T inv = (T)1 / line[i];
+            for (int k = 0; k < cs; k++) { xi[k] *= inv; }
+        }
+    }
+    template void solve(DMat<double>& result, const TriMat<double>& left, const DMat<double>& right);
+    template void solve(DMat<float>& result, const TriMat<float>& left, const DMat<float>& right);
+
+    template <typename T>
+    void lu(BandMat<T>& result, const BandMat<T>& value) {
+        if (&result != &value) { result = value; }
+        const int n = result.n;
+        const int kl = result.kl;
+        const int ku = result.ku;
+        for (int k = 0; k < n; k++) {
+            const T pivot = result(k, k);
+            if (pivot == (T)0) { throw std::runtime_error("Zero pivot in banded LU factorization"); }
+            const int lend = std::min(n, k + kl + 1);
+            const int uend = std::min(n, k + ku + 1);
+            for (int i = k + 1; i < lend; i++) {
+                const T l = result(i, k) / pivot;
+                result(i, k) = l;
+                for (int j = k + 1; j < uend; j++) { result(i, j) -= l*result(k, j); }
+            }
+        }
+    }
+    template void lu(BandMat<double>& result, const BandMat<double>& value);
+    template void lu(BandMat<float>& result, const BandMat<float>& value);
+
+    template <typename T>
+    void solveLU(DVec<T>& result, const BandMat<T>& factors, const DVec<T>& right) {
+        const T* b = right.data();
+        T* x = result.data();
+        const int n = factors.n;
+
+        // Forward substitution with the unit lower factor
+        for (int i = 0; i < n; i++) {
+            const T* line = &factors.data()[factors.index(i, 0)];
+            T sum = b[i];
+            for (int j = std::max(0, i - factors.kl); j < i; j++) { sum -= line[j]*x[j]; }
+            x[i] = sum;
+        }
+
+        // Backward substitution with the upper factor
+        for (int i = n - 1; i >= 0; i--) {
+            const T* line = &factors.data()[factors.index(i, 0)];
+            const int end = std::min(n, i + factors.ku + 1);
+            T sum = x[i];
+            for (int j = i + 1; j < end; j++) { sum -= line[j]*x[j]; }
+            x[i] = sum / line[i];
+        }
+    }
+    template void solveLU(DVec<double>& result, const BandMat<double>& factors, const DVec<double>& right);
+    template void solveLU(DVec<float>& result, const BandMat<float>& factors, const DVec<float>& right);
+
+    template <typename T>
+    void solve(DVec<T>& result, const BandMat<T>& left, const DVec<T>& right) {
+        if (left.kl != 1 || left.ku != 1) {
+            BandMat<T> factors;
+            lu(factors, left);
+            solveLU(result, factors, right);
+            return;
+        }
+
+        // Thomas algorithm, the modified right-hand side is kept in the result
+        const int n = left.n;
+        const T* d = right.data();
+        T* x = result.data();
+        DVec<T> c(n);
+        T m = left(0, 0);
+        for (int i = 0; i < n; i++) {
+            if (i) { m = left(i, i) - left(i, i - 1)*c[i - 1]; }
+            if (m == (T)0) { throw std::runtime_error("Zero pivot in tridiagonal solve"); }
+            c[i] = (i + 1 < n) ? left(i, i + 1) / m : (T)0;
+            x[i] = (i ? d[i] - left(i, i - 1)*x[i - 1] : d[i]) / m;
+        }
+        for (int i = n - 2; i >= 0; i--) { x[i] -= c[i]*x[i + 1]; }
+    }
+    template void solve(DVec<double>& result, const BandMat<double>& left, const DVec<double>& right);
+    template void solve(DVec<float>& result, const BandMat<float>& left, const DVec<float>& right);
+}
\ No newline at end of file
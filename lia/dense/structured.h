@@ -0,0 +1,277 @@
+#pragma once
+#include "dynamic.h"
+
+namespace lia {
+    /**
+     * Dynamically allocated symmetric matrix. Only the lower triangle is stored, packed line by line.
+    */
+    template <typename DT>
+    class SymMat {
+    public:
+        // Default constructor
+        SymMat() : n(0) {}
+
+        /**
+         * Create a symmetric matrix.
+         * @param size Number of lines and columns.
+        */
+        SymMat(int size) : n(size), _data((int)((int64_t)size*(size + 1) / 2)) {}
+
+        // Function operator to access elements, either triangle can be used
+        LIA_FORCE_INLINE DT& operator()(int line, int column) { return _data[index(line, column)]; }
+        LIA_FORCE_INLINE const DT& operator()(int line, int column) const { return _data[index(line, column)]; }
+
+        /**
+         * Get the position of an element in the packed storage.
+         * @param line Line of the element.
+         * @param column Column of the element.
+         * @return Index of the element in the data buffer.
+        */
+        static constexpr LIA_FORCE_INLINE int index(int line, int column) {
+            return (line >= column) ? (line*(line + 1) / 2 + column) : (column*(column + 1) / 2 + line);
+        }
+
+        /**
+         * Get the raw packed data buffer.
+         * @return Raw data buffer containing the lower triangle.
+        */
+        LIA_FORCE_INLINE DT* data() { return _data.data(); }
+        LIA_FORCE_INLINE const DT* data() const { return _data.data(); }
+
+        // Number of lines and columns
+        int n;
+
+    private:
+        DVec<DT> _data;
+    };
+
+    /**
+     * Dynamically allocated triangular matrix. Only the triangle is stored, packed line by line.
+    */
+    template <typename DT>
+    class TriMat {
+    public:
+        // Default constructor
+        TriMat() : n(0), uplo(UPLO_LOWER) {}
+
+        /**
+         * Create a triangular matrix.
+         * @param size Number of lines and columns.
+         * @param uplo Triangle holding the elements, the other one being zero.
+        */
+        TriMat(int size, Uplo uplo) : n(size), uplo(uplo), _data((int)((int64_t)size*(size + 1) / 2)) {}
+
+        // Function operator to access elements, which must be inside the triangle
+        LIA_FORCE_INLINE DT& operator()(int line, int column) { return _data[index(line, column)]; }
+        LIA_FORCE_INLINE const DT& operator()(int line, int column) const { return _data[index(line, column)]; }
+
+        /**
+         * Get an element of the matrix, including the zeros outside of the triangle.
+         * @param line Line of the element.
+         * @param column Column of the element.
+         * @return Value of the element.
+        */
+        LIA_FORCE_INLINE DT get(int line, int column) const {
+            const bool inside = (uplo == UPLO_LOWER) ? (line >= column) : (line <= column);
+            return inside ? _data[index(line, column)] : (DT)0;
+        }
+
+        /**
+         * Get the position of an element of the triangle in the packed storage.
+         * @param line Line of the element.
+         * @param column Column of the element.
+         * @return Index of the element in the data buffer.
+        */
+        LIA_FORCE_INLINE int index(int line, int column) const {
+            if (uplo == UPLO_LOWER) { return line*(line + 1) / 2 + column; }
+            return line*n - line*(line - 1) / 2 + column - line;
+        }
+
+        /**
+         * Get the raw packed data buffer.
+         * @return Raw data buffer containing the triangle.
+        */
+        LIA_FORCE_INLINE DT* data() { return _data.data(); }
+        LIA_FORCE_INLINE const DT* data() const { return _data.data(); }
+
+        // Number of lines and columns
+        int n;
+
+        // Triangle holding the elements
+        Uplo uplo;
+
+    private:
+        DVec<DT> _data;
+    };
+
+    /**
+     * Dynamically allocated banded matrix. Each line stores the kl elements left of the diagonal, the diagonal and
+     * the ku elements right of it, the positions falling outside of the matrix being padding.
+    */
+    template <typename DT>
+    class BandMat {
+    public:
+        // Default constructor
+        BandMat() : n(0), kl(0), ku(0) {}
+
+        /**
+         * Create a banded matrix.
+         * @param size Number of lines and columns.
+         * @param lower Number of sub-diagonals.
+         * @param upper Number of super-diagonals.
+        */
+        BandMat(int size, int lower, int upper) : n(size), kl(lower), ku(upper), _data(size*(lower + upper + 1)) {}
+
+        // Function operator to access elements, which must be inside the band
+        LIA_FORCE_INLINE DT& operator()(int line, int column) { return _data[index(line, column)]; }
+        LIA_FORCE_INLINE const DT& operator()(int line, int column) const { return _data[index(line, column)]; }
+
+        /**
+         * Get an element of the matrix, including the zeros outside of the band.
+         * @param line Line of the element.
+         * @param column Column of the element.
+         * @return Value of the element.
+        */
+        LIA_FORCE_INLINE DT get(int line, int column) const {
+            const int d = column - line;
+            return (d >= -kl && d <= ku) ? _data[index(line, column)] : (DT)0;
+        }
+
+        /**
+         * Get the position of an element of the band in the storage.
+         * @param line Line of the element.
+         * @param column Column of the element.
+         * @return Index of the element in the data buffer.
+        */
+        LIA_FORCE_INLINE int index(int line, int column) const { return line*(kl + ku + 1) + column - line + kl; }
+
+        /**
+         * Get the raw data buffer.
+         * @return Raw data buffer containing the band.
+        */
+        LIA_FORCE_INLINE DT* data() { return _data.data(); }
+        LIA_FORCE_INLINE const DT* data() const { return _data.data(); }
+
+        // Number of lines and columns
+        int n;
+
+        // Number of sub-diagonals
+        int kl;
+
+        // Number of super-diagonals
+        int ku;
+
+    private:
+        DVec<DT> _data;
+    };
+
+    // Common structured matrix types
+    using SymMatd = SymMat<double>;
+    using SymMatf = SymMat<float>;
+    using TriMatd = TriMat<double>;
+    using TriMatf = TriMat<float>;
+    using BandMatd = BandMat<double>;
+    using BandMatf = BandMat<float>;
+
+    // =============================== CONVERSION ===============================
+
+    /**
+     * Expand a structured matrix to a dense matrix.
+     * @param result Dense matrix to write the result to.
+     * @param value Structured matrix to expand.
+    */
+    template <typename T>
+    void toMat(DMat<T>& result, const SymMat<T>& value);
+    template <typename T>
+    void toMat(DMat<T>& result, const TriMat<T>& value);
+    template <typename T>
+    void toMat(DMat<T>& result, const BandMat<T>& value);
+
+    /**
+     * Pack a dense matrix into a structured matrix of the same size. Symmetric matrices take the lower triangle of
+     * the dense matrix, triangular and banded matrices take their own triangle or band, the rest being ignored.
+     * @param result Structured matrix to write the result to.
+     * @param value Dense matrix to pack.
+    */
+    template <typename T>
+    void fromMat(SymMat<T>& result, const DMat<T>& value);
+    template <typename T>
+    void fromMat(TriMat<T>& result, const DMat<T>& value);
+    template <typename T>
+    void fromMat(BandMat<T>& result, const DMat<T>& value);
+
+    // ============================== DOT PRODUCT ==============================
+
+    /**
+     * Take the dot product between a structured matrix and a vector or dense matrix, only touching the stored
+     * elements (SYMV/SYMM, TRMV/TRMM and banded equivalents). Dense matrices must be row-major, others throw
+     * std::invalid_argument.
+     * @param result Vector or matrix to write the result to.
+     * @param left Left-hand structured matrix.
+     * @param right Right-hand vector or matrix.
+    */
+    template <typename T>
+    void dot(DVec<T>& result, const SymMat<T>& left, const DVec<T>& right);
+    template <typename T>
+    void dot(DMat<T>& result, const SymMat<T>& left, const DMat<T>& right);
+    template <typename T>
+    void dot(DVec<T>& result, const TriMat<T>& left, const DVec<T>& right);
+    template <typename T>
+    void dot(DMat<T>& result, const TriMat<T>& left, const DMat<T>& right);
+    template <typename T>
+    void dot(DVec<T>& result, const BandMat<T>& left, const DVec<T>& right);
+    template <typename T>
+    void dot(DMat<T>& result, const BandMat<T>& left, const DMat<T>& right);
+
+    /**
+     * Compute the symmetric product of a matrix with its own transpose (SYRK), only computing the lower triangle.
+     * The matrix must be row-major, others throw std::invalid_argument.
+     * @param result Symmetric matrix to write value * transpose(value) to.
+     * @param value Matrix to multiply with its transpose.
+    */
+    template <typename T>
+    void syrk(SymMat<T>& result, const DMat<T>& value);
+
+    // ================================= SOLVE =================================
+
+    /**
+     * Solve a triangular system by forward or backward substitution. The result can alias the right-hand side.
+     * Dense matrices must be row-major, others throw std::invalid_argument.
+     * @param result Vector or matrix to write the solution to.
+     * @param left Triangular matrix of the system, its diagonal must not contain zeros.
+     * @param right Right-hand vector or matrix.
+    */
+    template <typename T>
+    void solve(DVec<T>& result, const TriMat<T>& left, const DVec<T>& right);
+    template <typename T>
+    void solve(DMat<T>& result, const TriMat<T>& left, const DMat<T>& right);
+
+    /**
+     * Factorize a banded matrix into LU form without pivoting, which keeps the factors inside the band. The unit
+     * lower factor is stored below the diagonal and the upper factor on and above it. The matrix should be
+     * diagonally dominant or positive definite, throws std::runtime_error on a zero pivot.
+     * @param result Banded matrix to write the factors to.
+     * @param value Banded matrix to factorize.
+    */
+    template <typename T>
+    void lu(BandMat<T>& result, const BandMat<T>& value);
+
+    /**
+     * Solve a banded system from its LU factors.
+     * @param result Vector to write the solution to.
+     * @param factors LU factors of the matrix of the system, as computed by lu.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    void solveLU(DVec<T>& result, const BandMat<T>& factors, const DVec<T>& right);
+
+    /**
+     * Solve a banded system without pivoting. Tridiagonal systems use the Thomas algorithm, other bandwidths a
+     * temporary LU factorization. Throws std::runtime_error on a zero pivot.
+     * @param result Vector to write the solution to.
+     * @param left Banded matrix of the system.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    void solve(DVec<T>& result, const BandMat<T>& left, const DVec<T>& right);
+}
\ No newline at end of file
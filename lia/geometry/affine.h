@@ -0,0 +1,247 @@
+#pragma once
+#include "transform.h"
+
+namespace lia {
+    /**
+     * Affine transform stored as the top 3x4 block of its homogeneous matrix, the implicit bottom row being [0 0 0 1].
+     * Columns 0 to 2 hold the linear part and column 3 holds the translation.
+    */
+    template <typename T>
+    class Affine {
+    public:
+        // Default constructor
+        constexpr LIA_FORCE_INLINE Affine() {}
+
+        /**
+         * Create an affine transform from the top 3x4 block of its homogeneous matrix.
+         * @param mat Top 3x4 block of the homogeneous matrix.
+        */
+        constexpr LIA_FORCE_INLINE Affine(const SMat<3, 4, T>& mat) : mat(mat) {}
+
+        // Identity transform
+        static constexpr LIA_FORCE_INLINE Affine identity() {
+            return Affine(SMat<3, 4, T>({ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 }));
+        }
+
+        // Function operator to access elements
+        constexpr LIA_FORCE_INLINE T& operator()(int line, int column) { return mat(line, column); }
+        constexpr LIA_FORCE_INLINE const T& operator()(int line, int column) const { return mat(line, column); }
+
+        // In-place composition operator
+        constexpr LIA_FORCE_INLINE void operator*=(const Affine& right) {
+            mul(*this, *this, right);
+        }
+
+        // Top 3x4 block of the homogeneous matrix
+        SMat<3, 4, T> mat;
+    };
+
+    // Common affine transform types
+    using Affined = Affine<double>;
+    using Affinef = Affine<float>;
+
+    // =============================== COMPOSITION ===============================
+
+    /**
+     * Compose two affine transforms, the right-hand one being applied first. Takes 36 multiplies instead of the 64
+     * of a full 4x4 product.
+     * @param result Transform to write the result to.
+     * @param left Left-hand transform.
+     * @param right Right-hand transform.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void mul(Affine<T>& result, const Affine<T>& left, const Affine<T>& right) {
+        const T* a = left.mat.data;
+        const T* b = right.mat.data;
+        T r[12];
+        for (int i = 0; i < 3; i++) {
+            const T* line = &a[i*4];
+            r[i*4 + 0] = line[0]*b[0] + line[1]*b[4] + line[2]*b[8];
+            r[i*4 + 1] = line[0]*b[1] + line[1]*b[5] + line[2]*b[9];
+            r[i*4 + 2] = line[0]*b[2] + line[1]*b[6] + line[2]*b[10];
+            r[i*4 + 3] = line[0]*b[3] + line[1]*b[7] + line[2]*b[11] + line[3];
+        }
+        for (int i = 0; i < 12; i++) { result.mat[i] = r[i]; }
+    }
+
+    // Affine transform composition operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE Affine<T> operator*(const Affine<T>& left, const Affine<T>& right) {
+        Affine<T> result;
+        mul(result, left, right);
+        return result;
+    }
+
+    /**
+     * Compose arrays of affine transforms, the right-hand ones being applied first.
+     * @param results Transforms to write the results to.
+     * @param lefts Left-hand transforms.
+     * @param rights Right-hand transforms.
+     * @param count Number of compositions.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void mul(Affine<T>* results, const Affine<T>* lefts, const Affine<T>* rights, int count) {
+        for (int i = 0; i < count; i++) {
+            mul(results[i], lefts[i], rights[i]);
+        }
+    }
+
+    // ================================= INVERSE =================================
+
+    /**
+     * Invert an affine transform. The linear part must not be singular.
+     * @param result Transform to write the result to.
+     * @param value Transform to invert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void invert(Affine<T>& result, const Affine<T>& value) {
+        // Invert the linear part from its cofactors
+        const T* m = value.mat.data;
+        const T c00 = m[5]*m[10] - m[6]*m[9];
+        const T c01 = m[6]*m[8] - m[4]*m[10];
+        const T c02 = m[4]*m[9] - m[5]*m[8];
+        const T inv = (T)1 / (m[0]*c00 + m[1]*c01 + m[2]*c02);
+        T r[12];
+        r[0] = c00*inv; r[1] = (m[2]*m[9] - m[1]*m[10])*inv; r[2] = (m[1]*m[6] - m[2]*m[5])*inv;
+        r[4] = c01*inv; r[5] = (m[0]*m[10] - m[2]*m[8])*inv; r[6] = (m[2]*m[4] - m[0]*m[6])*inv;
+        r[8] = c02*inv; r[9] = (m[1]*m[8] - m[0]*m[9])*inv; r[10] = (m[0]*m[5] - m[1]*m[4])*inv;
+
+        // The translation is the inverse linear part applied to the opposite translation
+        r[3] = -(r[0]*m[3] + r[1]*m[7] + r[2]*m[11]);
+        r[7] = -(r[4]*m[3] + r[5]*m[7] + r[6]*m[11]);
+        r[11] = -(r[8]*m[3] + r[9]*m[7] + r[10]*m[11]);
+        for (int i = 0; i < 12; i++) { result.mat[i] = r[i]; }
+    }
+
+    /**
+     * Invert a rigid affine transform, whose linear part is a rotation. Cheaper than invert since the inverse of the
+     * rotation is its transpose.
+     * @param result Transform to write the result to.
+     * @param value Rigid transform to invert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void invertRigid(Affine<T>& result, const Affine<T>& value) {
+        const T* m = value.mat.data;
+        T r[12];
+        r[0] = m[0]; r[1] = m[4]; r[2] = m[8];
+        r[4] = m[1]; r[5] = m[5]; r[6] = m[9];
+        r[8] = m[2]; r[9] = m[6]; r[10] = m[10];
+        r[3] = -(r[0]*m[3] + r[1]*m[7] + r[2]*m[11]);
+        r[7] = -(r[4]*m[3] + r[5]*m[7] + r[6]*m[11]);
+        r[11] = -(r[8]*m[3] + r[9]*m[7] + r[10]*m[11]);
+        for (int i = 0; i < 12; i++) { result.mat[i] = r[i]; }
+    }
+
+    // =============================== APPLICATION ===============================
+
+    /**
+     * Apply an affine transform to a point.
+     * @param result Vector to write the transformed point to.
+     * @param transform Transform to apply.
+     * @param value Point to transform.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void apply(SVec<3, T>& result, const Affine<T>& transform, const SVec<3, T>& value) {
+        const T* m = transform.mat.data;
+        const T* v = value.data;
+        const T x = m[0]*v[0] + m[1]*v[1] + m[2]*v[2] + m[3];
+        const T y = m[4]*v[0] + m[5]*v[1] + m[6]*v[2] + m[7];
+        const T z = m[8]*v[0] + m[9]*v[1] + m[10]*v[2] + m[11];
+        T* r = result.data;
+        r[0] = x; r[1] = y; r[2] = z;
+    }
+
+    /**
+     * Apply an affine transform to a direction, which ignores the translation.
+     * @param result Vector to write the transformed direction to.
+     * @param transform Transform to apply.
+     * @param value Direction to transform.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void applyDirection(SVec<3, T>& result, const Affine<T>& transform, const SVec<3, T>& value) {
+        const T* m = transform.mat.data;
+        const T* v = value.data;
+        const T x = m[0]*v[0] + m[1]*v[1] + m[2]*v[2];
+        const T y = m[4]*v[0] + m[5]*v[1] + m[6]*v[2];
+        const T z = m[8]*v[0] + m[9]*v[1] + m[10]*v[2];
+        T* r = result.data;
+        r[0] = x; r[1] = y; r[2] = z;
+    }
+
+    // Point transformation operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE SVec<3, T> operator*(const Affine<T>& left, const SVec<3, T>& right) {
+        SVec<3, T> result;
+        apply(result, left, right);
+        return result;
+    }
+
+    /**
+     * Apply an affine transform to an array of points.
+     * @param results Vectors to write the transformed points to.
+     * @param transform Transform to apply.
+     * @param values Points to transform.
+     * @param count Number of points.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void apply(SVec<3, T>* results, const Affine<T>& transform, const SVec<3, T>* values, int count) {
+        const Affine<T> m = transform;
+        for (int i = 0; i < count; i++) {
+            apply(results[i], m, values[i]);
+        }
+    }
+
+    /**
+     * Apply an affine transform to an array of directions, which ignores the translation.
+     * @param results Vectors to write the transformed directions to.
+     * @param transform Transform to apply.
+     * @param values Directions to transform.
+     * @param count Number of directions.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void applyDirection(SVec<3, T>* results, const Affine<T>& transform, const SVec<3, T>* values, int count) {
+        const Affine<T> m = transform;
+        for (int i = 0; i < count; i++) {
+            applyDirection(results[i], m, values[i]);
+        }
+    }
+
+    // ================================ CONVERSION ================================
+
+    /**
+     * Convert an affine transform to a homogeneous 4x4 matrix.
+     * @param result Matrix to write the result to.
+     * @param value Transform to convert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void toMat(SMat<4, 4, T>& result, const Affine<T>& value) {
+        for (int i = 0; i < 12; i++) { result[i] = value.mat[i]; }
+        result[12] = 0; result[13] = 0; result[14] = 0; result[15] = 1;
+    }
+
+    /**
+     * Convert a homogeneous 4x4 matrix to an affine transform. The bottom row of the matrix is assumed to be [0 0 0 1].
+     * @param result Transform to write the result to.
+     * @param value Matrix to convert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void fromMat(Affine<T>& result, const SMat<4, 4, T>& value) {
+        for (int i = 0; i < 12; i++) { result.mat[i] = value[i]; }
+    }
+
+    /**
+     * Convert a rigid transform to an affine transform.
+     * @param result Transform to write the result to.
+     * @param value Rigid transform to convert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void fromTransform(Affine<T>& result, const Transform<T>& value) {
+        SMat<3, 3, T> rot;
+        toMat(rot, value.rotation);
+        const T* t = value.translation.data;
+        T* r = result.mat.data;
+        r[0] = rot[0]; r[1] = rot[1]; r[2] = rot[2]; r[3] = t[0];
+        r[4] = rot[3]; r[5] = rot[4]; r[6] = rot[5]; r[7] = t[1];
+        r[8] = rot[6]; r[9] = rot[7]; r[10] = rot[8]; r[11] = t[2];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,338 @@
+#pragma once
+#include "../dense/static.h"
+
+namespace lia {
+    // Math functions in the precision of the element type
+    template <typename T>
+    static LIA_FORCE_INLINE T _sin(T value) {
+        if constexpr (std::is_same_v<T, float>) { return sinf(value); } else { return sin(value); }
+    }
+    template <typename T>
+    static LIA_FORCE_INLINE T _cos(T value) {
+        if constexpr (std::is_same_v<T, float>) { return cosf(value); } else { return cos(value); }
+    }
+    template <typename T>
+    static LIA_FORCE_INLINE T _acos(T value) {
+        if constexpr (std::is_same_v<T, float>) { return acosf(value); } else { return acos(value); }
+    }
+
+    /**
+     * Quaternion stored as its vector part followed by its scalar part (x, y, z, w). Rotations use unit quaternions.
+    */
+    template <typename T>
+    class Quat : public _XYZW<T> {
+    public:
+        // Default constructor
+        constexpr LIA_FORCE_INLINE Quat() {}
+
+        /**
+         * Create a quaternion from its components.
+         * @param x First component of the vector part.
+         * @param y Second component of the vector part.
+         * @param z Third component of the vector part.
+         * @param w Scalar part.
+        */
+        constexpr LIA_FORCE_INLINE Quat(T x, T y, T z, T w) {
+            _XYZW<T>::data[0] = x;
+            _XYZW<T>::data[1] = y;
+            _XYZW<T>::data[2] = z;
+            _XYZW<T>::data[3] = w;
+        }
+
+        /**
+         * Create the quaternion of a rotation around an axis.
+         * @param axis Unit vector of the rotation axis.
+         * @param angle Rotation angle in radians.
+         * @return Unit quaternion of the rotation.
+        */
+        static LIA_FORCE_INLINE Quat axisAngle(const SVec<3, T>& axis, T angle) {
+            const T s = _sin<T>(angle * (T)0.5);
+            return Quat(axis[0]*s, axis[1]*s, axis[2]*s, _cos<T>(angle * (T)0.5));
+        }
+
+        // Identity rotation
+        static constexpr LIA_FORCE_INLINE Quat identity() { return Quat(0, 0, 0, 1); }
+
+        // Array operator to access the components
+        constexpr LIA_FORCE_INLINE T& operator[](int id) { return _XYZW<T>::data[id]; }
+        constexpr LIA_FORCE_INLINE const T& operator[](int id) const { return _XYZW<T>::data[id]; }
+
+        // In-place composition operator
+        constexpr LIA_FORCE_INLINE void operator*=(const Quat& right) {
+            mul(*this, *this, right);
+        }
+    };
+
+    // Common quaternion types
+    using Quatd = Quat<double>;
+    using Quatf = Quat<float>;
+
+    // ================================ PRODUCT ================================
+
+    /**
+     * Take the Hamilton product of two quaternions. For unit quaternions, this composes the rotations with the
+     * right-hand one applied first.
+     * @param result Quaternion to write the result to.
+     * @param left Left-hand quaternion.
+     * @param right Right-hand quaternion.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void mul(Quat<T>& result, const Quat<T>& left, const Quat<T>& right) {
+        const T* a = left.data;
+        const T* b = right.data;
+        const T x = a[3]*b[0] + a[0]*b[3] + a[1]*b[2] - a[2]*b[1];
+        const T y = a[3]*b[1] - a[0]*b[2] + a[1]*b[3] + a[2]*b[0];
+        const T z = a[3]*b[2] + a[0]*b[1] - a[1]*b[0] + a[2]*b[3];
+        const T w = a[3]*b[3] - a[0]*b[0] - a[1]*b[1] - a[2]*b[2];
+        T* r = result.data;
+        r[0] = x; r[1] = y; r[2] = z; r[3] = w;
+    }
+
+    // Quaternion product operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE Quat<T> operator*(const Quat<T>& left, const Quat<T>& right) {
+        Quat<T> result;
+        mul(result, left, right);
+        return result;
+    }
+
+#ifdef LIA_STATIC_SSE
+    // Hamilton product of two single-precision quaternions held in SSE registers
+    static LIA_FORCE_INLINE __m128 _mul(__m128 a, __m128 b) {
+        const __m128 sx = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+        const __m128 sy = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, (int)0x80000000, 0, 0));
+        const __m128 sz = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, 0, (int)0x80000000));
+        __m128 r = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), sx)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), sy)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), sz)));
+        return r;
+    }
+#endif
+
+    /**
+     * Take the Hamilton products of arrays of quaternions.
+     * @param results Quaternions to write the results to.
+     * @param lefts Left-hand quaternions.
+     * @param rights Right-hand quaternions.
+     * @param count Number of products.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void mul(Quat<T>* results, const Quat<T>* lefts, const Quat<T>* rights, int count) {
+#ifdef LIA_STATIC_SSE
+        if constexpr (std::is_same_v<T, float>) {
+            for (int i = 0; i < count; i++) {
+                _mm_storeu_ps(results[i].data, _mul(_mm_loadu_ps(lefts[i].data), _mm_loadu_ps(rights[i].data)));
+            }
+            return;
+        }
+#endif
+        for (int i = 0; i < count; i++) {
+            mul(results[i], lefts[i], rights[i]);
+        }
+    }
+
+    // =============================== CONJUGATE ===============================
+
+    /**
+     * Conjugate a quaternion. For unit quaternions, this gives the inverse rotation.
+     * @param result Quaternion to write the result to.
+     * @param value Quaternion to conjugate.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void conjugate(Quat<T>& result, const Quat<T>& value) {
+        const T* v = value.data;
+        T* r = result.data;
+        r[0] = -v[0]; r[1] = -v[1]; r[2] = -v[2]; r[3] = v[3];
+    }
+
+    // Conjugate operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE Quat<T> operator~(const Quat<T>& value) {
+        Quat<T> result;
+        conjugate(result, value);
+        return result;
+    }
+
+    // ================================= NORM =================================
+
+    /**
+     * Compute the norm of a quaternion.
+     * @param value Quaternion to take the norm of.
+     * @return Norm of the quaternion.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE T norm(const Quat<T>& value) {
+        const T* v = value.data;
+        return _sqrt<T>(v[0]*v[0] + v[1]*v[1] + v[2]*v[2] + v[3]*v[3]);
+    }
+
+    /**
+     * Normalize a quaternion to unit norm.
+     * @param result Quaternion to write the result to.
+     * @param value Quaternion to normalize.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void normalize(Quat<T>& result, const Quat<T>& value) {
+        const T* v = value.data;
+        T* r = result.data;
+        const T inv = (T)1 / norm(value);
+        r[0] = v[0]*inv; r[1] = v[1]*inv; r[2] = v[2]*inv; r[3] = v[3]*inv;
+    }
+
+    // =============================== ROTATION ===============================
+
+    /**
+     * Rotate a vector by a unit quaternion.
+     * @param result Vector to write the result to.
+     * @param rotation Unit quaternion of the rotation.
+     * @param value Vector to rotate.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void rotate(SVec<3, T>& result, const Quat<T>& rotation, const SVec<3, T>& value) {
+        // v' = v + w*t + u x t with t = 2*(u x v), u being the vector part of the quaternion
+        const T* q = rotation.data;
+        const T* v = value.data;
+        const T tx = 2*(q[1]*v[2] - q[2]*v[1]);
+        const T ty = 2*(q[2]*v[0] - q[0]*v[2]);
+        const T tz = 2*(q[0]*v[1] - q[1]*v[0]);
+        const T x = v[0] + q[3]*tx + (q[1]*tz - q[2]*ty);
+        const T y = v[1] + q[3]*ty + (q[2]*tx - q[0]*tz);
+        const T z = v[2] + q[3]*tz + (q[0]*ty - q[1]*tx);
+        T* r = result.data;
+        r[0] = x; r[1] = y; r[2] = z;
+    }
+
+    // Vector rotation operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE SVec<3, T> operator*(const Quat<T>& left, const SVec<3, T>& right) {
+        SVec<3, T> result;
+        rotate(result, left, right);
+        return result;
+    }
+
+    /**
+     * Rotate arrays of vectors by unit quaternions.
+     * @param results Vectors to write the results to.
+     * @param rotations Unit quaternions of the rotations.
+     * @param values Vectors to rotate.
+     * @param count Number of vectors.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void rotate(SVec<3, T>* results, const Quat<T>* rotations, const SVec<3, T>* values, int count) {
+        for (int i = 0; i < count; i++) {
+            rotate(results[i], rotations[i], values[i]);
+        }
+    }
+
+    // ============================= INTERPOLATION =============================
+
+    /**
+     * Interpolate linearly between two unit quaternions along the shortest path and renormalize the result.
+     * Cheaper than slerp but the angular velocity isn't constant.
+     * @param result Quaternion to write the result to.
+     * @param from Quaternion at t = 0.
+     * @param to Quaternion at t = 1.
+     * @param t Interpolation parameter between 0 and 1.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void nlerp(Quat<T>& result, const Quat<T>& from, const Quat<T>& to, T t) {
+        const T* a = from.data;
+        const T* b = to.data;
+        const T cosine = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+        const T s0 = 1 - t;
+        const T s1 = (cosine < 0) ? -t : t;
+        T* r = result.data;
+        r[0] = s0*a[0] + s1*b[0]; r[1] = s0*a[1] + s1*b[1]; r[2] = s0*a[2] + s1*b[2]; r[3] = s0*a[3] + s1*b[3];
+        normalize(result, result);
+    }
+
+    /**
+     * Interpolate spherically between two unit quaternions along the shortest path, at constant angular velocity.
+     * @param result Quaternion to write the result to.
+     * @param from Quaternion at t = 0.
+     * @param to Quaternion at t = 1.
+     * @param t Interpolation parameter between 0 and 1.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void slerp(Quat<T>& result, const Quat<T>& from, const Quat<T>& to, T t) {
+        const T* a = from.data;
+        const T* b = to.data;
+        T cosine = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+        const T sign = (cosine < 0) ? -1 : 1;
+        cosine *= sign;
+
+        // Nearly identical rotations are interpolated linearly to avoid dividing by a vanishing sine
+        if (cosine > (T)0.9995) {
+            nlerp(result, from, to, t);
+            return;
+        }
+
+        const T angle = _acos<T>(cosine);
+        const T inv = (T)1 / _sin<T>(angle);
+        const T s0 = _sin<T>((1 - t)*angle) * inv;
+        const T s1 = _sin<T>(t*angle) * inv * sign;
+        T* r = result.data;
+        r[0] = s0*a[0] + s1*b[0]; r[1] = s0*a[1] + s1*b[1]; r[2] = s0*a[2] + s1*b[2]; r[3] = s0*a[3] + s1*b[3];
+    }
+
+    // ============================== CONVERSION ==============================
+
+    /**
+     * Convert a unit quaternion to a rotation matrix.
+     * @param result Matrix to write the result to.
+     * @param value Unit quaternion to convert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void toMat(SMat<3, 3, T>& result, const Quat<T>& value) {
+        const T* q = value.data;
+        const T xx = q[0]*q[0], yy = q[1]*q[1], zz = q[2]*q[2];
+        const T xy = q[0]*q[1], xz = q[0]*q[2], yz = q[1]*q[2];
+        const T wx = q[3]*q[0], wy = q[3]*q[1], wz = q[3]*q[2];
+        T* r = result.data;
+        r[0] = 1 - 2*(yy + zz); r[1] = 2*(xy - wz); r[2] = 2*(xz + wy);
+        r[3] = 2*(xy + wz); r[4] = 1 - 2*(xx + zz); r[5] = 2*(yz - wx);
+        r[6] = 2*(xz - wy); r[7] = 2*(yz + wx); r[8] = 1 - 2*(xx + yy);
+    }
+
+    /**
+     * Convert a rotation matrix to a unit quaternion.
+     * @param result Quaternion to write the result to.
+     * @param value Rotation matrix to convert.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void fromMat(Quat<T>& result, const SMat<3, 3, T>& value) {
+        // Use the largest diagonal term to keep the square root well conditioned (Shepperd's method)
+        const T* m = value.data;
+        T* r = result.data;
+        const T trace = m[0] + m[4] + m[8];
+        if (trace > 0) {
+            const T s = _sqrt<T>(trace + 1) * 2;
+            r[0] = (m[7] - m[5]) / s;
+            r[1] = (m[2] - m[6]) / s;
+            r[2] = (m[3] - m[1]) / s;
+            r[3] = s / 4;
+        }
+        else if (m[0] > m[4] && m[0] > m[8]) {
+            const T s = _sqrt<T>(1 + m[0] - m[4] - m[8]) * 2;
+            r[0] = s / 4;
+            r[1] = (m[1] + m[3]) / s;
+            r[2] = (m[2] + m[6]) / s;
+            r[3] = (m[7] - m[5]) / s;
+        }
+        else if (m[4] > m[8]) {
+            const T s = _sqrt<T>(1 + m[4] - m[0] - m[8]) * 2;
+            r[0] = (m[1] + m[3]) / s;
+            r[1] = s / 4;
+            r[2] = (m[5] + m[7]) / s;
+            r[3] = (m[2] - m[6]) / s;
+        }
+        else {
+            const T s = _sqrt<T>(1 + m[8] - m[0] - m[4]) * 2;
+            r[0] = (m[2] + m[6]) / s;
+            r[1] = (m[5] + m[7]) / s;
+            r[2] = s / 4;
+            r[3] = (m[3] - m[1]) / s;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+#include "quat.h"
+
+namespace lia {
+    /**
+     * Rigid transform made of a rotation followed by a translation.
+    */
+    template <typename T>
+    class Transform {
+    public:
+        // Default constructor
+        constexpr LIA_FORCE_INLINE Transform() {}
+
+        /**
+         * Create a transform from a rotation and a translation.
+         * @param rotation Unit quaternion of the rotation, applied first.
+         * @param translation Translation, applied after the rotation.
+        */
+        constexpr LIA_FORCE_INLINE Transform(const Quat<T>& rotation, const SVec<3, T>& translation) :
+            rotation(rotation), translation(translation) {}
+
+        // Identity transform
+        static constexpr LIA_FORCE_INLINE Transform identity() { return Transform(Quat<T>::identity(), SVec<3, T>(0, 0, 0)); }
+
+        // In-place composition operator
+        constexpr LIA_FORCE_INLINE void operator*=(const Transform& right) {
+            mul(*this, *this, right);
+        }
+
+        // Rotation of the transform
+        Quat<T> rotation;
+
+        // Translation of the transform
+        SVec<3, T> translation;
+    };
+
+    // Common transform types
+    using Transformd = Transform<double>;
+    using Transformf = Transform<float>;
+
+    // =============================== COMPOSITION ===============================
+
+    /**
+     * Compose two transforms, the right-hand one being applied first.
+     * @param result Transform to write the result to.
+     * @param left Left-hand transform.
+     * @param right Right-hand transform.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void mul(Transform<T>& result, const Transform<T>& left, const Transform<T>& right) {
+        SVec<3, T> t;
+        rotate(t, left.rotation, right.translation);
+        add(result.translation, t, left.translation);
+        mul(result.rotation, left.rotation, right.rotation);
+    }
+
+    // Transform composition operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE Transform<T> operator*(const Transform<T>& left, const Transform<T>& right) {
+        Transform<T> result;
+        mul(result, left, right);
+        return result;
+    }
+
+    /**
+     * Compose arrays of transforms, the right-hand ones being applied first.
+     * @param results Transforms to write the results to.
+     * @param lefts Left-hand transforms.
+     * @param rights Right-hand transforms.
+     * @param count Number of compositions.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void mul(Transform<T>* results, const Transform<T>* lefts, const Transform<T>* rights, int count) {
+        for (int i = 0; i < count; i++) {
+            mul(results[i], lefts[i], rights[i]);
+        }
+    }
+
+    // ================================= INVERSE =================================
+
+    /**
+     * Invert a transform.
+     * @param result Transform to write the result to.
+     * @param value Transform to invert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void invert(Transform<T>& result, const Transform<T>& value) {
+        Quat<T> inv;
+        conjugate(inv, value.rotation);
+        SVec<3, T> t;
+        rotate(t, inv, value.translation);
+        result.rotation = inv;
+        result.translation = SVec<3, T>(-t[0], -t[1], -t[2]);
+    }
+
+    // =============================== APPLICATION ===============================
+
+    /**
+     * Apply a transform to a point.
+     * @param result Vector to write the transformed point to.
+     * @param transform Transform to apply.
+     * @param value Point to transform.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void apply(SVec<3, T>& result, const Transform<T>& transform, const SVec<3, T>& value) {
+        rotate(result, transform.rotation, value);
+        add(result, result, transform.translation);
+    }
+
+    // Point transformation operator
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE SVec<3, T> operator*(const Transform<T>& left, const SVec<3, T>& right) {
+        SVec<3, T> result;
+        apply(result, left, right);
+        return result;
+    }
+
+    /**
+     * Apply transforms to arrays of points.
+     * @param results Vectors to write the transformed points to.
+     * @param transforms Transforms to apply.
+     * @param values Points to transform.
+     * @param count Number of points.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void apply(SVec<3, T>* results, const Transform<T>* transforms, const SVec<3, T>* values, int count) {
+        for (int i = 0; i < count; i++) {
+            apply(results[i], transforms[i], values[i]);
+        }
+    }
+
+    // ================================ CONVERSION ================================
+
+    /**
+     * Convert a transform to a homogeneous 4x4 matrix.
+     * @param result Matrix to write the result to.
+     * @param value Transform to convert.
+    */
+    template <typename T>
+    static constexpr LIA_FORCE_INLINE void toMat(SMat<4, 4, T>& result, const Transform<T>& value) {
+        SMat<3, 3, T> rot;
+        toMat(rot, value.rotation);
+        const T* m = rot.data;
+        const T* t = value.translation.data;
+        T* r = result.data;
+        r[0] = m[0]; r[1] = m[1]; r[2] = m[2]; r[3] = t[0];
+        r[4] = m[3]; r[5] = m[4]; r[6] = m[5]; r[7] = t[1];
+        r[8] = m[6]; r[9] = m[7]; r[10] = m[8]; r[11] = t[2];
+        r[12] = 0; r[13] = 0; r[14] = 0; r[15] = 1;
+    }
+
+    /**
+     * Convert a homogeneous 4x4 matrix of a rigid transform to a transform.
+     * @param result Transform to write the result to.
+     * @param value Matrix to convert.
+    */
+    template <typename T>
+    static LIA_FORCE_INLINE void fromMat(Transform<T>& result, const SMat<4, 4, T>& value) {
+        const T* m = value.data;
+        const SMat<3, 3, T> rot = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+        fromMat(result.rotation, rot);
+        result.translation = SVec<3, T>(m[3], m[7], m[11]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "binary.h"
+#include <stdexcept>
+#include <limits.h>
+#include <string.h>
+#include <stdio.h>
+
+namespace lia {
+    static_assert(sizeof(BinaryHeader) == 64, "The binary header must be 64 bytes long");
+
+    // Current version of the container format
+    #define LIA_BINARY_VERSION  1
+
+    // Element type identifiers
+    template <typename T> struct _BinaryType {};
+    template <> struct _BinaryType<double> { static const uint8_t id = 1; };
+    template <> struct _BinaryType<float> { static const uint8_t id = 2; };
+    template <> struct _BinaryType<int> { static const uint8_t id = 3; };
+    template <> struct _BinaryType<int8_t> { static const uint8_t id = 4; };
+
+    // FNV-1a hash over 64bit words, falling back to bytes for the tail
+    static uint64_t _checksum(const uint8_t* data, uint64_t size) {
+        const uint64_t prime = 0x100000001B3ULL;
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        uint64_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, &data[i], 8);
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < size; i++) {
+            hash = (hash ^ data[i]) * prime;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    const char* checkHeader(const BinaryHeader& hdr, uint64_t fileSize) {
+        if (fileSize < sizeof(BinaryHeader) || memcmp(hdr.magic, "LIAM", 4)) {
+            return "Not a lia binary container";
+        }
+        if (hdr.endianness != 0x01020304) {
+            return "The container was written with a different byte order";
+        }
+        if (hdr.version != LIA_BINARY_VERSION) {
+            return "Unsupported container version";
+        }
+        if (hdr.type != _BinaryType<T>::id || hdr.elementSize != sizeof(T)) {
+            return "Element type mismatch";
+        }
+        if (hdr.lines < 0 || hdr.columns < 0 || hdr.lines > INT_MAX || hdr.columns > INT_MAX ||
+            hdr.lines * hdr.columns > INT_MAX) {
+            return "Matrix size out of range";
+        }
+
+        // The size is divided rather than the element count multiplied, which could overflow
+        if (hdr.offset < sizeof(BinaryHeader) || hdr.offset % alignof(T) || hdr.offset > fileSize || hdr.size > fileSize - hdr.offset ||
+            hdr.size % sizeof(T) || hdr.size / sizeof(T) != (uint64_t)hdr.lines * (uint64_t)hdr.columns) {
+            return "Corrupted header";
+        }
+        return NULL;
+    }
+    template const char* checkHeader<double>(const BinaryHeader& hdr, uint64_t fileSize);
+    template const char* checkHeader<float>(const BinaryHeader& hdr, uint64_t fileSize);
+    template const char* checkHeader<int>(const BinaryHeader& hdr, uint64_t fileSize);
+    template const char* checkHeader<int8_t>(const BinaryHeader& hdr, uint64_t fileSize);
+
+    template <typename T>
+    void save(const std::string& path, const DMat<T>& value, int alignment) {
+        // Check the alignment
+        if (alignment < (int)sizeof(BinaryHeader) || (alignment & (alignment - 1))) {
+            throw std::runtime_error("Invalid payload alignment");
+        }
+
+        // The payload is row-major, column-major matrices are written from a row-major copy
+        const DMat<T>* src = &value;
+        DMat<T> copy;
+        if (value.layout() != LAYOUT_ROW_MAJOR) {
+            copy = DMat<T>(value.ls, value.cs);
+            for (int j = 0; j < value.cs; j++) {
+                for (int i = 0; i < value.ls; i++) { copy(i, j) = value(i, j); }
+            }
+            src = &copy;
+        }
+
+        // Fill in the header
+        BinaryHeader hdr;
+        memset(&hdr, 0, sizeof(BinaryHeader));
+        memcpy(hdr.magic, "LIAM", 4);
+        hdr.version = LIA_BINARY_VERSION;
+        hdr.type = _BinaryType<T>::id;
+        hdr.elementSize = sizeof(T);
+        hdr.endianness = 0x01020304;
+        hdr.alignment = alignment;
+        hdr.lines = value.ls;
+        hdr.columns = value.cs;
+        hdr.offset = alignment;
+        hdr.size = (uint64_t)value.ls * (uint64_t)value.cs * sizeof(T);
+        hdr.checksum = _checksum((const uint8_t*)src->data(), hdr.size);
+
+        // Open the file
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (!fp) { throw std::runtime_error("Could not open file for writing"); }
+
+        // Write the header, padding and payload
+        bool ok = (fwrite(&hdr, sizeof(BinaryHeader), 1, fp) == 1);
+        for (int i = sizeof(BinaryHeader); ok && i < alignment; i++) {
+            ok = (fputc(0, fp) != EOF);
+        }
+        if (ok && hdr.size) {
+            ok = (fwrite(src->data(), 1, hdr.size, fp) == hdr.size);
+        }
+
+        // Close the file
+        if (fclose(fp) || !ok) { throw std::runtime_error("Could not write file"); }
+    }
+    template void save(const std::string& path, const DMat<double>& value, int alignment);
+    template void save(const std::string& path, const DMat<float>& value, int alignment);
+    template void save(const std::string& path, const DMat<int>& value, int alignment);
+    template void save(const std::string& path, const DMat<int8_t>& value, int alignment);
+
+    template <typename DT>
+    MappedDMat<DT>::MappedDMat(const std::string& path, bool verify) : _file(path) {
+        // Validate the header
+        if (_file.size() < sizeof(BinaryHeader)) { throw std::runtime_error("Not a lia binary container"); }
+        const BinaryHeader* hdr = (const BinaryHeader*)_file.data();
+        const char* err = checkHeader<DT>(*hdr, _file.size());
+        if (!err && verify && _checksum(_file.data() + hdr->offset, hdr->size) != hdr->checksum) {
+            err = "Checksum mismatch";
+        }
+        if (err) { throw std::runtime_error(err); }
+
+        // Create a matrix viewing the payload
+        _mat = new DMat<DT>((int)hdr->lines, (int)hdr->columns, (DT*)(_file.data() + hdr->offset));
+    }
+
+    template <typename DT>
+    MappedDMat<DT>::~MappedDMat() {
+        // Destroy the view, the file is unmapped afterwards
+        delete _mat;
+    }
+
+    template class MappedDMat<double>;
+    template class MappedDMat<float>;
+    template class MappedDMat<int>;
+    template class MappedDMat<int8_t>;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+#include <string>
+#include <stdint.h>
+#include "../dense/dynamic.h"
+#include "file_map.h"
+
+namespace lia {
+    /**
+     * Header of the lia binary matrix container. All fields are stored in the byte order of the machine that wrote
+     * the file, the endianness marker allows detecting foreign files. The payload is stored in row-major order
+     * starting at the given offset, which is a multiple of the alignment.
+    */
+    struct BinaryHeader {
+        // Magic number, always "LIAM"
+        char magic[4];
+
+        // Version of the container format
+        uint16_t version;
+
+        // Element type identifier
+        uint8_t type;
+
+        // Size of an element in bytes
+        uint8_t elementSize;
+
+        // Endianness marker, reads as 0x01020304 on a machine with the same byte order as the writer
+        uint32_t endianness;
+
+        // Alignment of the payload in bytes
+        uint32_t alignment;
+
+        // Number of lines
+        int64_t lines;
+
+        // Number of columns
+        int64_t columns;
+
+        // Offset of the payload from the start of the file
+        uint64_t offset;
+
+        // Size of the payload in bytes
+        uint64_t size;
+
+        // FNV-1a checksum of the payload
+        uint64_t checksum;
+
+        // Reserved for future use
+        uint8_t reserved[8];
+    };
+
+    /**
+     * Check that a header describes a valid container of a given element type, with a number of lines, columns and
+     * elements that fits in an int and a payload that starts after the header.
+     * @param hdr Header to check.
+     * @param fileSize Size of the file the header was read from.
+     * @return NULL if the header is valid, otherwise a description of the problem.
+    */
+    template <typename T>
+    const char* checkHeader(const BinaryHeader& hdr, uint64_t fileSize);
+
+    /**
+     * Save a matrix or vector to a lia binary container. Column-major matrices are written in row-major order.
+     * @param path Path of the file to write.
+     * @param value Matrix or vector to save.
+     * @param alignment Alignment of the payload in bytes, must be a power of two no smaller than the 64 byte header.
+     * Throws std::runtime_error otherwise.
+    */
+    template <typename T>
+    void save(const std::string& path, const DMat<T>& value, int alignment = 64);
+
+    /**
+     * Read-only matrix backed directly by a memory mapped lia binary container.
+     * Mapping the file takes constant time regardless of its size, pages are only read when they are accessed.
+    */
+    template <typename DT>
+    class MappedDMat {
+    public:
+        /**
+         * Map a lia binary container.
+         * @param path Path of the file to map.
+         * @param verify Verify the checksum of the payload. This reads the entire file.
+        */
+        MappedDMat(const std::string& path, bool verify = false);
+
+        // Mappings can't be copied
+        MappedDMat(const MappedDMat& copy) = delete;
+
+        // Destructor
+        ~MappedDMat();
+
+        // Access the mapped matrix
+        LIA_FORCE_INLINE const DMat<DT>& operator*() const { return *_mat; }
+        LIA_FORCE_INLINE const DMat<DT>* operator->() const { return _mat; }
+        LIA_FORCE_INLINE operator const DMat<DT>&() const { return *_mat; }
+
+    private:
+        // Mapping of the container
+        FileMap _file;
+
+        // Matrix viewing the payload
+        DMat<DT>* _mat;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "file_map.h"
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lia {
+    FileMap::FileMap(const std::string& path) {
+#ifdef _WIN32
+        // Open the file
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (_file == INVALID_HANDLE_VALUE) { throw std::runtime_error("Could not open file"); }
+
+        // Get its size
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size)) {
+            CloseHandle(_file);
+            throw std::runtime_error("Could not get the file size");
+        }
+        _size = (size_t)size.QuadPart;
+
+        // Empty files can't be mapped
+        _mapping = NULL;
+        _map = NULL;
+        if (!_size) { return; }
+
+        // Map it
+        _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        _map = _mapping ? MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (!_map) {
+            if (_mapping) { CloseHandle(_mapping); }
+            CloseHandle(_file);
+            throw std::runtime_error("Could not map file");
+        }
+#else
+        // Open the file
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) { throw std::runtime_error("Could not open file"); }
+
+        // Get its size
+        struct stat st;
+        if (fstat(fd, &st)) {
+            close(fd);
+            throw std::runtime_error("Could not get the file size");
+        }
+        _size = (size_t)st.st_size;
+
+        // Empty files can't be mapped
+        _map = NULL;
+        if (!_size) {
+            close(fd);
+            return;
+        }
+
+        // Map it, the mapping stays valid once the file is closed
+        _map = mmap(NULL, _size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (_map == MAP_FAILED) { throw std::runtime_error("Could not map file"); }
+#endif
+    }
+
+    FileMap::~FileMap() {
+#ifdef _WIN32
+        if (_map) { UnmapViewOfFile(_map); }
+        if (_mapping) { CloseHandle(_mapping); }
+        CloseHandle(_file);
+#else
+        if (_map) { munmap(_map, _size); }
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace lia {
+    /**
+     * Read-only memory mapping of an entire file.
+    */
+    class FileMap {
+    public:
+        /**
+         * Map a file.
+         * @param path Path of the file to map.
+        */
+        FileMap(const std::string& path);
+
+        // Mappings can't be copied
+        FileMap(const FileMap& copy) = delete;
+
+        // Destructor
+        ~FileMap();
+
+        /**
+         * Get the mapped file contents.
+         * @return Start of the mapping, NULL if the file is empty.
+        */
+        const uint8_t* data() const { return (const uint8_t*)_map; }
+
+        /**
+         * Get the size of the mapped file.
+         * @return Size of the file in bytes.
+        */
+        size_t size() const { return _size; }
+
+    private:
+        // Base address and size of the mapping
+        void* _map;
+        size_t _size;
+
+#ifdef _WIN32
+        // File and file mapping handles
+        void* _file;
+        void* _mapping;
+#endif
+    };
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "stream.h"
+#include "binary.h"
+#include <stdexcept>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <string.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lia {
+    // Target size of a panel when none is given
+    #define LIA_STREAM_PANEL_BYTES  (32 << 20)
+
+    template <typename DT>
+    struct StreamedDMat<DT>::_Container {
+        BinaryHeader hdr;
+#ifdef _WIN32
+        void* file;
+#else
+        int fd;
+#endif
+    };
+
+    template <typename DT>
+    typename StreamedDMat<DT>::_Container StreamedDMat<DT>::_open(const std::string& path) {
+        _Container cont;
+        uint64_t size;
+        bool ok;
+#ifdef _WIN32
+        // Open the file and read the header
+        cont.file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (cont.file == INVALID_HANDLE_VALUE) { throw std::runtime_error("Could not open file"); }
+        LARGE_INTEGER lsize;
+        DWORD read = 0;
+        ok = GetFileSizeEx(cont.file, &lsize) && ReadFile(cont.file, &cont.hdr, sizeof(BinaryHeader), &read, NULL) && read == sizeof(BinaryHeader);
+        size = (uint64_t)lsize.QuadPart;
+#else
+        // Open the file and read the header
+        cont.fd = open(path.c_str(), O_RDONLY);
+        if (cont.fd < 0) { throw std::runtime_error("Could not open file"); }
+        struct stat st;
+        ok = !fstat(cont.fd, &st) && pread(cont.fd, &cont.hdr, sizeof(BinaryHeader), 0) == sizeof(BinaryHeader);
+        size = (uint64_t)st.st_size;
+#endif
+
+        // Validate the header
+        const char* err = ok ? checkHeader<DT>(cont.hdr, size) : "Could not read the header";
+        if (err) {
+#ifdef _WIN32
+            CloseHandle(cont.file);
+#else
+            close(cont.fd);
+#endif
+            throw std::runtime_error(err);
+        }
+
+        return cont;
+    }
+
+    // Select the number of lines per panel, at most as many as fit in a matrix with an int element count
+    template <typename DT>
+    static int _panelLines(int cs, int requested) {
+        const int lines = (requested > 0) ? requested : std::max<int>(1, LIA_STREAM_PANEL_BYTES / std::max<size_t>(1, (size_t)cs * sizeof(DT)));
+        return std::min<int>(lines, std::max<int>(1, INT_MAX / std::max<int>(1, cs)));
+    }
+
+    template <typename DT>
+    StreamedDMat<DT>::StreamedDMat(const std::string& path, int panelLines) : StreamedDMat(_open(path), panelLines) {}
+
+    template <typename DT>
+    StreamedDMat<DT>::StreamedDMat(const _Container& cont, int panelLines) :
+        ls((int)cont.hdr.lines),
+        cs((int)cont.hdr.columns),
+        panel(_panelLines<DT>((int)cont.hdr.columns, panelLines)) {
+        // Save the payload offset and file handle
+        _offset = cont.hdr.offset;
+#ifdef _WIN32
+        _file = cont.file;
+#else
+        _fd = cont.fd;
+#endif
+    }
+
+    template <typename DT>
+    StreamedDMat<DT>::~StreamedDMat() {
+        // Close the file
+#ifdef _WIN32
+        CloseHandle(_file);
+#else
+        close(_fd);
+#endif
+    }
+
+    template <typename DT>
+    void StreamedDMat<DT>::read(DT* buffer, int line, int count) const {
+        uint8_t* dst = (uint8_t*)buffer;
+        uint64_t offset = _offset + (uint64_t)line * (uint64_t)cs * sizeof(DT);
+        uint64_t left = (uint64_t)count * (uint64_t)cs * sizeof(DT);
+
+        // Read until everything was received since reads can be partial
+        while (left) {
+            const uint32_t chunk = (uint32_t)std::min<uint64_t>(left, 1 << 30);
+#ifdef _WIN32
+            OVERLAPPED ov;
+            memset(&ov, 0, sizeof(OVERLAPPED));
+            ov.Offset = (DWORD)offset;
+            ov.OffsetHigh = (DWORD)(offset >> 32);
+            DWORD got = 0;
+            if (!ReadFile(_file, dst, chunk, &got, &ov) || !got) { throw std::runtime_error("Could not read panel"); }
+#else
+            ssize_t got = pread(_fd, dst, chunk, (off_t)offset);
+            if (got <= 0) { throw std::runtime_error("Could not read panel"); }
+#endif
+            dst += got;
+            offset += got;
+            left -= got;
+        }
+    }
+
+    template class StreamedDMat<double>;
+    template class StreamedDMat<float>;
+    template class StreamedDMat<int>;
+
+    // Stream the panels of a matrix, reading the next panel in the background while the current one is processed
+    template <typename T, class F>
+    static void _stream(const StreamedDMat<T>& mat, F process) {
+        const int ls = mat.ls;
+        const int cs = mat.cs;
+        const int panel = std::min(mat.panel, ls);
+        if (!panel) { return; }
+
+        // Allocate the two panel buffers and read the first panel
+        std::unique_ptr<T[]> bufs[2] = { std::unique_ptr<T[]>(new T[(size_t)panel*cs]), std::unique_ptr<T[]>(new T[(size_t)panel*cs]) };
+        mat.read(bufs[0].get(), 0, panel);
+
+        int cur = 0;
+        for (int line = 0; line < ls; line += panel) {
+            // Start reading the next panel into the other buffer
+            const int next = line + panel;
+            std::future<void> pending;
+            if (next < ls) {
+                T* buf = bufs[cur ^ 1].get();
+                const int count = std::min(panel, ls - next);
+                pending = std::async(std::launch::async, [&mat, buf, next, count]() { mat.read(buf, next, count); });
+            }
+
+            // Process the resident panel
+            DMat<T> view(std::min(panel, ls - line), cs, bufs[cur].get());
+            process(view, line);
+
+            // Wait for the next panel, rethrowing any read error
+            if (pending.valid()) { pending.get(); }
+            cur ^= 1;
+        }
+    }
+
+    template <typename T>
+    void dot(DVec<T>& result, const StreamedDMat<T>& left, const DVec<T>& right) {
+        T* r = result.data();
+        _stream(left, [=, &right](const DMat<T>& view, int line) {
+            DVec<T> slice(view.ls, &r[line]);
+            dot(slice, view, right);
+        });
+    }
+    template void dot(DVec<double>& result, const StreamedDMat<double>& left, const DVec<double>& right);
+    template void dot(DVec<float>& result, const StreamedDMat<float>& left, const DVec<float>& right);
+    template void dot(DVec<int>& result, const StreamedDMat<int>& left, const DVec<int>& right);
+
+    template <typename T>
+    void tdot(DVec<T>& result, const StreamedDMat<T>& left, const DVec<T>& right) {
+        const T* x = right.data();
+        T* r = result.data();
+        const int cs = left.cs;
+        clear(result, (T)0);
+        _stream(left, [=](const DMat<T>& view, int line) {
+            const T* v = view.data();
+            const int ls = view.ls;
+            for (int i = 0; i < ls; i++) {
+                const T* vline = &v[i*cs];
+                const T xi = x[line + i];
+                for (int j = 0; j < cs; j++) {
+                    r[j] += vline[j] * xi;
+                }
+            }
+        });
+    }
+    template void tdot(DVec<double>& result, const StreamedDMat<double>& left, const DVec<double>& right);
+    template void tdot(DVec<float>& result, const StreamedDMat<float>& left, const DVec<float>& right);
+    template void tdot(DVec<int>& result, const StreamedDMat<int>& left, const DVec<int>& right);
+
+    template <typename T>
+    void gram(DMat<T>& result, const StreamedDMat<T>& value) {
+        T* r = result.data();
+        const int cs = value.cs;
+        clear(result, (T)0);
+
+        // Accumulate the upper triangle one line at a time
+        _stream(value, [=](const DMat<T>& view, int) {
+            const T* v = view.data();
+            const int ls = view.ls;
+            for (int i = 0; i < ls; i++) {
+                const T* vline = &v[i*cs];
+                for (int j = 0; j < cs; j++) {
+                    T* rline = &r[j*cs];
+                    const T vj = vline[j];
+                    for (int k = j; k < cs; k++) {
+                        rline[k] += vj * vline[k];
+                    }
+                }
+            }
+        });
+
+        // Mirror it to the lower triangle
+        for (int j = 0; j < cs; j++) {
+            for (int k = j + 1; k < cs; k++) {
+                r[k*cs + j] = r[j*cs + k];
+            }
+        }
+    }
+    template void gram(DMat<double>& result, const StreamedDMat<double>& value);
+    template void gram(DMat<float>& result, const StreamedDMat<float>& value);
+    template void gram(DMat<int>& result, const StreamedDMat<int>& value);
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <stdint.h>
+#include "../dense/dynamic.h"
+
+namespace lia {
+    /**
+     * Matrix streamed from a lia binary container in panels of lines, for matrices too large to fit in memory.
+     * Only two panels are ever resident: the one being computed on and the one being read in the background.
+    */
+    template <typename DT>
+    class StreamedDMat {
+    public:
+        /**
+         * Open a lia binary container for streaming.
+         * @param path Path of the container.
+         * @param panelLines Number of lines per panel. Zero selects panels of roughly 32MB. Clamped so that a panel
+         * holds at most INT_MAX elements.
+        */
+        StreamedDMat(const std::string& path, int panelLines = 0);
+
+        // Streamed matrices can't be copied
+        StreamedDMat(const StreamedDMat& copy) = delete;
+
+        // Destructor
+        ~StreamedDMat();
+
+        /**
+         * Read a range of lines from the file.
+         * @param buffer Buffer to read the lines into.
+         * @param line First line to read.
+         * @param count Number of lines to read.
+        */
+        void read(DT* buffer, int line, int count) const;
+
+        // Number of lines
+        const int ls;
+
+        // Number of columns
+        const int cs;
+
+        // Number of lines per panel
+        const int panel;
+
+    private:
+        // Opened container, defined in the implementation
+        struct _Container;
+        static _Container _open(const std::string& path);
+        StreamedDMat(const _Container& container, int panelLines);
+
+        // Offset of the payload in the file
+        uint64_t _offset;
+
+        // File handle
+#ifdef _WIN32
+        void* _file;
+#else
+        int _fd;
+#endif
+    };
+
+    /**
+     * Take the dot product between a streamed matrix and a vector.
+     * @param result Vector to write the result to.
+     * @param left Left-hand streamed matrix.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    void dot(DVec<T>& result, const StreamedDMat<T>& left, const DVec<T>& right);
+
+    /**
+     * Take the dot product between the transpose of a streamed matrix and a vector.
+     * @param result Vector to write the result to.
+     * @param left Left-hand streamed matrix, used transposed.
+     * @param right Right-hand vector.
+    */
+    template <typename T>
+    void tdot(DVec<T>& result, const StreamedDMat<T>& left, const DVec<T>& right);
+
+    /**
+     * Compute the Gram matrix (transpose of the matrix times the matrix) of a streamed matrix.
+     * @param result Square matrix to write the result to.
+     * @param value Streamed matrix.
+    */
+    template <typename T>
+    void gram(DMat<T>& result, const StreamedDMat<T>& value);
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "text.h"
+#include "file_map.h"
+#include "../thread_pool.h"
+#include <charconv>
+#include <stdexcept>
+#include <vector>
+#include <stdio.h>
+
+namespace lia {
+    // Minimum number of bytes parsed or lines written by a thread
+    #define LIA_TEXT_MIN_CHUNK_BYTES    (1 << 20)
+    #define LIA_TEXT_MIN_CHUNK_LINES    256
+
+    // Check if a character is blank
+    static LIA_FORCE_INLINE bool _isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // Check if a character is a delimiter, at most one can separate two elements
+    static LIA_FORCE_INLINE bool _isDelimiter(char c) {
+        return c == ',' || c == ';';
+    }
+
+    // Skip blanks, stopping at the end of the line
+    static LIA_FORCE_INLINE const char* _skip(const char* p, const char* end) {
+        while (p < end && _isBlank(*p)) { p++; }
+        return p;
+    }
+
+    // Move to the next element of a line or to its end, rejecting empty fields
+    static LIA_FORCE_INLINE const char* _nextField(const char* p, const char* end, bool first) {
+        p = _skip(p, end);
+        if (p >= end || !_isDelimiter(*p)) { return p; }
+        if (first) { throw std::runtime_error("Empty field"); }
+        p = _skip(p + 1, end);
+        if (p >= end || *p == '\n' || _isDelimiter(*p)) { throw std::runtime_error("Empty field"); }
+        return p;
+    }
+
+    // Find the start of the line following a position
+    static LIA_FORCE_INLINE const char* _nextLine(const char* p, const char* end) {
+        while (p < end && *p != '\n') { p++; }
+        return (p < end) ? p + 1 : end;
+    }
+
+    // Count the non-blank lines in a range
+    static int _countLines(const char* p, const char* end) {
+        int count = 0;
+        while (p < end) {
+            p = _skip(p, end);
+            if (p < end && *p != '\n') { count++; }
+            p = _nextLine(p, end);
+        }
+        return count;
+    }
+
+    // Parse the non-blank lines of a range into consecutive lines of the matrix
+    template <typename T>
+    static void _parseLines(T* r, int cs, const char* p, const char* end) {
+        while (p < end) {
+            // Skip blank lines
+            p = _skip(p, end);
+            if (p >= end) { break; }
+            if (*p == '\n') {
+                p++;
+                continue;
+            }
+
+            // Parse the elements of the line
+            for (int j = 0; j < cs; j++) {
+                p = _nextField(p, end, !j);
+                if (p >= end || *p == '\n') { throw std::runtime_error("Line has too few elements"); }
+                // from_chars doesn't accept a leading plus, skip it only when it starts a number
+                if (*p == '+' && p + 1 < end && ((p[1] >= '0' && p[1] <= '9') || p[1] == '.')) { p++; }
+                std::from_chars_result res = std::from_chars(p, end, r[j]);
+                if (res.ec != std::errc()) { throw std::runtime_error("Invalid number"); }
+
+                // The number must span the whole element
+                p = res.ptr;
+                if (p < end && *p != '\n' && !_isBlank(*p) && !_isDelimiter(*p)) { throw std::runtime_error("Invalid number"); }
+            }
+
+            // Make sure nothing is left on the line
+            p = _nextField(p, end, false);
+            if (p < end && *p != '\n') { throw std::runtime_error("Line has too many elements"); }
+            if (p < end) { p++; }
+            r += cs;
+        }
+    }
+
+    template <typename T>
+    DMat<T> loadText(const std::string& path) {
+        FileMap file(path);
+        const char* text = (const char*)file.data();
+        const char* end = text + file.size();
+
+        // Count the elements on the first non-blank line to get the number of columns
+        const char* p = text;
+        while (p < end) {
+            p = _skip(p, end);
+            if (p >= end || *p != '\n') { break; }
+            p++;
+        }
+        int cs = 0;
+        p = _nextField(p, end, true);
+        while (p < end && *p != '\n') {
+            cs++;
+            while (p < end && *p != '\n' && !_isBlank(*p) && !_isDelimiter(*p)) { p++; }
+            p = _nextField(p, end, false);
+        }
+
+        // Split the file into chunks starting on line boundaries
+        const int maxChunks = ThreadPool::global().threads();
+        int chunks = (int)(file.size() / LIA_TEXT_MIN_CHUNK_BYTES);
+        if (chunks > maxChunks) { chunks = maxChunks; }
+        if (chunks < 1) { chunks = 1; }
+        std::vector<const char*> bounds(chunks + 1);
+        bounds[0] = text;
+        bounds[chunks] = end;
+        for (int i = 1; i < chunks; i++) {
+            const char* b = text + (file.size() / chunks) * i;
+            b = _nextLine(b - 1, end);
+            bounds[i] = (b > bounds[i-1]) ? b : bounds[i-1];
+        }
+
+        // Count the lines of each chunk in parallel and compute the first line of each chunk
+        std::vector<int> first(chunks + 1, 0);
+        ThreadPool::global().run(chunks, [&](int id) {
+            first[id + 1] = _countLines(bounds[id], bounds[id + 1]);
+        });
+        for (int i = 0; i < chunks; i++) { first[i + 1] += first[i]; }
+
+        // Parse the chunks in parallel directly into the matrix
+        DMat<T> result(first[chunks], cs);
+        T* r = result.data();
+        ThreadPool::global().run(chunks, [&](int id) {
+            _parseLines(&r[first[id]*cs], cs, bounds[id], bounds[id + 1]);
+        });
+
+        return result;
+    }
+    template DMat<double> loadText(const std::string& path);
+    template DMat<float> loadText(const std::string& path);
+    template DMat<int> loadText(const std::string& path);
+
+    template <typename T>
+    void saveText(const std::string& path, const DMat<T>& value, char delimiter) {
+        const T* v = value.data();
+        const int ls = value.ls;
+        const int cs = value.cs;
+
+        // Format blocks of lines in parallel
+        int chunks = ls / LIA_TEXT_MIN_CHUNK_LINES;
+        if (chunks > ThreadPool::global().threads()) { chunks = ThreadPool::global().threads(); }
+        if (chunks < 1) { chunks = 1; }
+        std::vector<std::string> blocks(chunks);
+        ThreadPool::global().run(chunks, [&](int id) {
+            int begin, end;
+            partition(ls, chunks, id, begin, end);
+            std::string& out = blocks[id];
+            char buf[64];
+            for (int i = begin; i < end; i++) {
+                for (int j = 0; j < cs; j++) {
+                    if (j) { out += delimiter; }
+                    std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), v[value.index(i, j)]);
+                    out.append(buf, res.ptr);
+                }
+                out += '\n';
+            }
+        });
+
+        // Write the blocks in order
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (!fp) { throw std::runtime_error("Could not open file for writing"); }
+        bool ok = true;
+        for (const auto& b : blocks) {
+            if (ok && !b.empty()) { ok = (fwrite(b.data(), 1, b.size(), fp) == b.size()); }
+        }
+        if (fclose(fp) || !ok) { throw std::runtime_error("Could not write file"); }
+    }
+    template void saveText(const std::string& path, const DMat<double>& value, char delimiter);
+    template void saveText(const std::string& path, const DMat<float>& value, char delimiter);
+    template void saveText(const std::string& path, const DMat<int>& value, char delimiter);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include "../dense/dynamic.h"
+
+namespace lia {
+    /**
+     * Load a matrix from a text file. Each non-blank line of the file is a line of the matrix, elements are separated
+     * by spaces or tabs and at most one comma or semicolon. Empty fields, such as two consecutive commas, are rejected.
+     * The file is parsed in parallel directly into the matrix.
+     * @param path Path of the file to load.
+     * @return Loaded matrix.
+    */
+    template <typename T>
+    DMat<T> loadText(const std::string& path);
+
+    /**
+     * Save a matrix to a text file, one line of the matrix per line whatever its layout. Elements are written in their
+     * shortest form that parses back to the same value.
+     * @param path Path of the file to write.
+     * @param value Matrix to save.
+     * @param delimiter Character written between the elements of a line.
+    */
+    template <typename T>
+    void saveText(const std::string& path, const DMat<T>& value, char delimiter = ',');
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "numa.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace lia {
+    // Memory policy from linux/mempolicy.h, redefined to avoid depending on libnuma headers
+    #define LIA_MPOL_INTERLEAVE 3
+
+    // Maximum number of nodes supported
+    #define LIA_NUMA_MAX_NODES  64
+
+#ifdef __linux__
+    // Parse a sysfs CPU or node list (eg. "0-3,8-11") and call a function with each id
+    template <class F>
+    static bool _parseList(const std::string& path, F callback) {
+        FILE* fp = fopen(path.c_str(), "r");
+        if (!fp) { return false; }
+        int first, last;
+        char sep;
+        while (fscanf(fp, "%d", &first) == 1) {
+            last = first;
+            sep = (char)fgetc(fp);
+            if (sep == '-') {
+                if (fscanf(fp, "%d", &last) != 1) { break; }
+                sep = (char)fgetc(fp);
+            }
+            for (int i = first; i <= last; i++) { callback(i); }
+            if (sep != ',') { break; }
+        }
+        fclose(fp);
+        return true;
+    }
+#endif
+
+    int numaNodes() {
+#ifdef __linux__
+        static const int count = []() {
+            int n = 0;
+            _parseList("/sys/devices/system/node/online", [&](int node) {
+                if (node + 1 > n) { n = node + 1; }
+            });
+            if (n > LIA_NUMA_MAX_NODES) { n = LIA_NUMA_MAX_NODES; }
+            return n > 0 ? n : 1;
+        }();
+        return count;
+#else
+        return 1;
+#endif
+    }
+
+    bool numaInterleave(void* addr, size_t size) {
+#if defined(__linux__) && defined(SYS_mbind)
+        const int nodes = numaNodes();
+        if (nodes < 2) { return false; }
+        uint64_t mask = (nodes >= 64) ? ~0ULL : ((1ULL << nodes) - 1);
+        return !syscall(SYS_mbind, addr, size, LIA_MPOL_INTERLEAVE, &mask, (unsigned long)nodes + 1, 0);
+#else
+        return false;
+#endif
+    }
+
+    bool numaPin(int node) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        bool any = false;
+        _parseList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", [&](int cpu) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+                any = true;
+            }
+        });
+        return any && !sched_setaffinity(0, sizeof(cpu_set_t), &set);
+#else
+        return false;
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <stddef.h>
+
+namespace lia {
+    /**
+     * Get the number of NUMA nodes of the machine.
+     * @return Number of nodes, one if the machine isn't NUMA or the topology is unknown.
+    */
+    int numaNodes();
+
+    /**
+     * Interleave the pages of a memory range across all NUMA nodes. Must be called before the pages are touched.
+     * @param addr Page aligned start of the range.
+     * @param size Size of the range in bytes.
+     * @return True on success, false if not supported.
+    */
+    bool numaInterleave(void* addr, size_t size);
+
+    /**
+     * Pin the calling thread to the CPUs of a NUMA node.
+     * @param node Node to pin the thread to.
+     * @return True on success, false if not supported.
+    */
+    bool numaPin(int node);
+}
\ No newline at end of file
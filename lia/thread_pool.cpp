@@ -0,0 +1,169 @@
+#include "thread_pool.h"
+#include "numa.h"
+#include <stdlib.h>
+
+namespace lia {
+    // Set on the worker threads and on callers while they are running a job
+    static thread_local bool _inJob = false;
+
+    ThreadPool::ThreadPool(int threads) {
+        // Default to the number of hardware threads
+        if (threads <= 0) { threads = (int)std::thread::hardware_concurrency(); }
+        if (threads <= 0) { threads = 1; }
+
+        // Start the workers, the caller acts as thread zero
+        for (int i = 1; i < threads; i++) {
+            _workers.push_back(std::thread(&ThreadPool::worker, this, i));
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        // Tell the workers to stop
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            _stop = true;
+        }
+        _cnd.notify_all();
+
+        // Wait for them to exit
+        for (auto& w : _workers) { w.join(); }
+    }
+
+    void ThreadPool::run(int count, const std::function<void(int)>& task) {
+        // Run inline if the pool can't take the job
+        if (count <= 0 || tryRun(count, task)) { return; }
+        for (int i = 0; i < count; i++) { task(i); }
+    }
+
+    bool ThreadPool::tryRun(int count, const std::function<void(int)>& task) {
+        if (count <= 0) { return true; }
+
+        // Refuse if nested, if there's nothing to parallelize or if another caller is using the pool
+        std::unique_lock<std::mutex> sub(_submitMtx, std::defer_lock);
+        if (_inJob || count == 1 || _workers.empty() || !sub.try_lock()) { return false; }
+
+        // Publish the job
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            _task = &task;
+            _count = count;
+            _done = 0;
+            _error = nullptr;
+            _generation++;
+        }
+        _cnd.notify_all();
+
+        // Process the chunks of thread zero
+        _inJob = true;
+        process(0, &task, count);
+        _inJob = false;
+
+        // Wait for the workers to finish their chunks
+        std::unique_lock<std::mutex> lck(_mtx);
+        _doneCnd.wait(lck, [this]() { return _done == _count; });
+        _task = nullptr;
+        std::exception_ptr err = _error;
+        lck.unlock();
+
+        // Rethrow the first error
+        if (err) { std::rethrow_exception(err); }
+        return true;
+    }
+
+    bool ThreadPool::pin() {
+        // Nothing to do on machines with a single node
+        const int nodes = numaNodes();
+        if (nodes < 2 || _workers.empty()) { return false; }
+
+        // Ask the workers to pin themselves
+        std::unique_lock<std::mutex> lck(_mtx);
+        if (!_pinNodes) {
+            _pinNodes = nodes;
+            _cnd.notify_all();
+        }
+
+        // Wait for all of them to reply, a task can't since its own worker may be the one to wait for
+        const int workers = (int)_workers.size();
+        if (_inJob) { return _pinReplies == workers && !_pinFailed; }
+        _pinCnd.wait(lck, [this, workers]() { return _pinReplies == workers; });
+        return !_pinFailed;
+    }
+
+    void ThreadPool::process(int thread, const std::function<void(int)>* task, int count) {
+        // Run the chunks assigned to the thread
+        const int stride = threads();
+        int processed = 0;
+        for (int id = thread; id < count; id += stride) {
+            try { (*task)(id); }
+            catch (...) {
+                std::lock_guard<std::mutex> lck(_mtx);
+                if (!_error) { _error = std::current_exception(); }
+            }
+            processed++;
+        }
+
+        // Report them as done
+        if (!processed) { return; }
+        std::lock_guard<std::mutex> lck(_mtx);
+        _done += processed;
+        if (_done == _count) { _doneCnd.notify_all(); }
+    }
+
+    void ThreadPool::worker(int thread) {
+        _inJob = true;
+        uint64_t seen = 0;
+        bool pinned = false;
+        std::unique_lock<std::mutex> lck(_mtx);
+        while (true) {
+            // Wait for a new job or a pinning request
+            _cnd.wait(lck, [&]() { return _stop || (_pinNodes && !pinned) || (_task && _generation != seen); });
+            if (_stop) { return; }
+
+            // Pin the thread to a node, keeping neighbouring threads on the same node
+            if (_pinNodes && !pinned) {
+                pinned = true;
+                const int node = thread * _pinNodes / threads();
+                lck.unlock();
+                const bool ok = numaPin(node);
+                lck.lock();
+                if (!ok) { _pinFailed = true; }
+                if (++_pinReplies == (int)_workers.size()) { _pinCnd.notify_all(); }
+                continue;
+            }
+            seen = _generation;
+            const std::function<void(int)>* task = _task;
+            const int count = _count;
+
+            // Process the chunks of this thread
+            lck.unlock();
+            process(thread, task, count);
+            lck.lock();
+        }
+    }
+
+    ThreadPool& ThreadPool::global() {
+        // The LIA_THREADS environment variable overrides the number of threads
+        static ThreadPool pool([]() {
+            const char* env = getenv("LIA_THREADS");
+            return env ? atoi(env) : 0;
+        }());
+        return pool;
+    }
+
+    void parallelFor(int count, int minChunk, const std::function<void(int begin, int end)>& task) {
+        if (count <= 0) { return; }
+
+        // Select the number of chunks
+        ThreadPool& pool = ThreadPool::global();
+        int chunks = count / (minChunk > 0 ? minChunk : 1);
+        if (chunks > pool.threads()) { chunks = pool.threads(); }
+        if (chunks < 1) { chunks = 1; }
+
+        // Run the chunks
+        pool.run(chunks, [&](int id) {
+            int begin, end;
+            partition(count, chunks, id, begin, end);
+            task(begin, end);
+        });
+    }
+}
\ No newline at end of file
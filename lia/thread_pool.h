@@ -0,0 +1,130 @@
+#pragma once
+#include <functional>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdint.h>
+
+namespace lia {
+    /**
+     * Pool of worker threads running data-parallel kernels. The calling thread always takes part in the work as
+     * thread zero. Chunks are assigned statically, chunk i always runs on thread i modulo the number of threads, so
+     * that kernels using the same partitioning touch the same memory from the same thread (and NUMA node).
+     * Calls made from inside a task, or while the pool is busy with another caller, run inline on the calling
+     * thread so that kernels never oversubscribe the machine or deadlock.
+    */
+    class ThreadPool {
+    public:
+        /**
+         * Create a thread pool.
+         * @param threads Total number of threads including the caller. Zero selects the number of hardware threads.
+        */
+        ThreadPool(int threads = 0);
+
+        // Thread pools can't be copied
+        ThreadPool(const ThreadPool& copy) = delete;
+
+        // Destructor
+        ~ThreadPool();
+
+        /**
+         * Run a task once for each chunk id and wait for all of them to finish.
+         * The first exception thrown by a task is rethrown in the caller.
+         * @param count Number of chunks.
+         * @param task Task to run, called with the id of the chunk.
+        */
+        void run(int count, const std::function<void(int)>& task);
+
+        /**
+         * Run a task once for each chunk id on the threads of the pool and wait for all of them to finish. Unlike run,
+         * never falls back to running the chunks inline, so that chunk i is guaranteed to run on thread i modulo the
+         * number of threads. The first exception thrown by a task is rethrown in the caller.
+         * @param count Number of chunks.
+         * @param task Task to run, called with the id of the chunk.
+         * @return True if the chunks ran, false if they couldn't run in parallel, in which case the task isn't called.
+        */
+        bool tryRun(int count, const std::function<void(int)>& task);
+
+        /**
+         * Get the total number of threads, including the caller.
+         * @return Number of threads.
+        */
+        int threads() const { return (int)_workers.size() + 1; }
+
+        /**
+         * Pin the worker threads of the pool, spreading them evenly across NUMA nodes. Each worker pins itself once it
+         * is idle, the calling thread is never pinned. Waits for all the workers unless called from inside a task.
+         * Does nothing on machines with a single node.
+         * @return True if all the workers are pinned.
+        */
+        bool pin();
+
+        /**
+         * Get the pool shared by all lia kernels. Its number of threads can be set with the LIA_THREADS environment
+         * variable, it defaults to the number of hardware threads.
+         * @return Global thread pool.
+        */
+        static ThreadPool& global();
+
+    private:
+        // Run the chunks of the current job assigned to a thread
+        void process(int thread, const std::function<void(int)>* task, int count);
+
+        // Worker thread loop
+        void worker(int thread);
+
+        // Worker threads
+        std::vector<std::thread> _workers;
+
+        // Held by the caller whose job is running
+        std::mutex _submitMtx;
+
+        // Protects the job state
+        std::mutex _mtx;
+        std::condition_variable _cnd;
+        std::condition_variable _doneCnd;
+
+        // Current job
+        const std::function<void(int)>* _task = nullptr;
+        int _count = 0;
+        int _done = 0;
+        uint64_t _generation = 0;
+        std::exception_ptr _error;
+
+        // Set when the workers must exit
+        bool _stop = false;
+
+        // Number of NUMA nodes to pin the workers to, zero until pinning is requested
+        int _pinNodes = 0;
+
+        // Number of workers that tried to pin themselves and whether they all succeeded
+        int _pinReplies = 0;
+        bool _pinFailed = false;
+        std::condition_variable _pinCnd;
+    };
+
+    /**
+     * Compute the bounds of a chunk when splitting a range into contiguous chunks of near equal size.
+     * @param count Number of items.
+     * @param chunks Number of chunks.
+     * @param id Id of the chunk.
+     * @param begin First item of the chunk.
+     * @param end Item following the last item of the chunk.
+    */
+    inline void partition(int count, int chunks, int id, int& begin, int& end) {
+        const int base = count / chunks;
+        const int extra = count % chunks;
+        begin = id*base + (id < extra ? id : extra);
+        end = begin + base + (id < extra ? 1 : 0);
+    }
+
+    /**
+     * Split a range into one contiguous chunk per thread of the global pool and process the chunks in parallel.
+     * @param count Number of items.
+     * @param minChunk Minimum number of items per chunk, fewer threads are used for small ranges.
+     * @param task Task to run, called with the bounds of the chunk.
+    */
+    void parallelFor(int count, int minChunk, const std::function<void(int begin, int end)>& task);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "utt/utt.h"
+#include "../lia/async.h"
+#include <math.h>
+
+static inline void fillRandom(lia::DMatd& m) {
+    for (int i = 0; i < m.ls*m.cs; i++) { m[i] = (double)rand() / (double)RAND_MAX; }
+}
+
+// Dependent kernels chained inside a coroutine
+static lia::async::Future<double> product(lia::DMatd& result, const lia::DMatd& a, const lia::DMatd& b, lia::DMatd& tmp) {
+    co_await lia::async::dot(tmp, a, b);
+    co_await lia::async::add(result, tmp, a);
+    co_await lia::async::mul(result, result, 0.5);
+    co_return result[0];
+}
+
+UT("Async Coroutine", {
+    lia::DMatd a(40, 40), b(40, 40), tmp(40, 40), r(40, 40);
+    fillRandom(a);
+    fillRandom(b);
+    lia::async::Future<double> f = product(r, a, b, tmp);
+
+    // Reference computed synchronously meanwhile
+    lia::DMatd ref(40, 40), t(40, 40);
+    lia::dot(t, a, b);
+    lia::add(ref, t, a);
+    lia::mul(ref, ref, 0.5);
+    if (f.get() != ref[0]) { throw std::runtime_error("Result"); }
+    for (int i = 0; i < 40*40; i++) {
+        if (r[i] != ref[i]) { throw std::runtime_error("Matrix"); }
+    }
+})
+
+UT("Async Task Graph", {
+    lia::DMatd a(30, 20), b(20, 30), c(30, 20), d(20, 30);
+    lia::DMatd ab(30, 30), cd(30, 30), r(30, 30);
+    fillRandom(a); fillRandom(b); fillRandom(c); fillRandom(d);
+
+    // Two independent products joined before their sum and its norm
+    lia::async::Future<> f1 = lia::async::dot(ab, a, b);
+    lia::async::Future<> f2 = lia::async::dot(cd, c, d);
+    lia::DVecd flat(30*30, r.data());
+    lia::async::Future<double> n = lia::async::whenAll(f1, f2).then([&]() { lia::add(r, ab, cd); })
+                                                                .then([&]() { return lia::norm(flat); });
+
+    lia::DMatd ref1(30, 30), ref2(30, 30), ref(30, 30);
+    lia::dot(ref1, a, b);
+    lia::dot(ref2, c, d);
+    lia::add(ref, ref1, ref2);
+    lia::DVecd refFlat(30*30, ref.data());
+    if (n.get() != lia::norm(refFlat)) { throw std::runtime_error("Graph"); }
+    if (!f1.ready() || !f2.ready()) { throw std::runtime_error("Ready"); }
+})
+
+UT("Async Exceptions", {
+    lia::async::Future<> f = lia::async::run([]() { throw std::runtime_error("Kernel failed"); });
+    bool ran = false;
+    lia::async::Future<> g = f.then([&]() { ran = true; });
+    lia::async::Future<> h = lia::async::whenAll(lia::async::run([]() {}), g);
+    bool thrown = false;
+    try { h.get(); }
+    catch (const std::runtime_error& e) { thrown = true; }
+    if (!thrown || ran) { throw std::runtime_error(""); }
+})
+
+// Blocks on a kernel after being resumed, which must neither stop the dispatcher nor deadlock
+static lia::async::Future<double> blocking(lia::DMatd& c, const lia::DMatd& a) {
+    co_await lia::async::add(c, a, a);
+    lia::async::add(c, c, c).get();
+    co_return c[0];
+}
+
+// Awaits a coroutine that is itself resumed on the resume thread, then blocks on it
+static lia::async::Future<double> nested(lia::DMatd& c, const lia::DMatd& a, lia::DMatd& d) {
+    co_await lia::async::mul(d, a, 3.0);
+    const double inner = blocking(c, a).get();
+    co_return inner + d[0];
+}
+
+UT("Async Blocking", {
+    lia::DMatd a(20, 20), c(20, 20), d(20, 20);
+    fillRandom(a);
+    if (blocking(c, a).get() != 4.0 * a[0]) { throw std::runtime_error("Coroutine"); }
+    if (nested(c, a, d).get() != 4.0 * a[0] + 3.0 * a[0]) { throw std::runtime_error("Nested"); }
+
+    // A kernel blocking on another kernel runs it from the dispatcher queue meanwhile
+    lia::DMatd e(20, 20);
+    lia::async::Future<double> f = lia::async::run([&]() {
+        lia::async::add(e, a, a).get();
+        return e[0];
+    });
+    if (f.get() != 2.0 * a[0]) { throw std::runtime_error("Kernel"); }
+})
\ No newline at end of file
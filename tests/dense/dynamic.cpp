@@ -1,5 +1,12 @@
 #include "../utt/utt.h"
 #include "../../lia/dense/dynamic.h"
+#include "../../lia/numa.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <string.h>
+#include <limits.h>
+#include <type_traits>
 
 template <int d>
 static inline lia::DVecd randVec() {
@@ -75,7 +82,7 @@ UT("Dynamic Norm", {
     for (int i = 0; i < 42; i++) {
         sum += a[i]*a[i];
     }
-    if (sqrt(sum) != b) { throw std::runtime_error(""); }
+    if (fabs(sqrt(sum) - b) > 1e-14) { throw std::runtime_error(""); }
 })
 
 UT("Dynamic Add(Vec)", {
@@ -172,7 +179,7 @@ UT("Dynamic Dot(Vec * Vec)", {
     for (int k = 0; k < 42; k++) {
         sum += a[k] * b[k];
     }
-    if (c != sum) {
+    if (fabs(c - sum) > 1e-14) {
         throw std::runtime_error("");
     }
 })
@@ -227,3 +234,725 @@ UT("Dynamic Cross", {
         throw std::runtime_error("");
     }
 })
+
+template <int ls, int cs>
+static inline lia::DMati8 randQMat() {
+    lia::DMati8 mat(ls, cs);
+    for (int i = 0; i < ls*cs; i++) {
+        mat[i] = (int8_t)((rand() % 256) - 128);
+    }
+    return mat;
+}
+
+template <int d>
+static inline void randQParams(lia::DVecf& scales, lia::DVeci& zeros) {
+    for (int i = 0; i < d; i++) {
+        scales[i] = 0.01f + (float)rand() / (float)RAND_MAX;
+        zeros[i] = (rand() % 21) - 10;
+    }
+}
+
+UT("Dynamic Quantized Dot(Raw)", {
+    lia::DMati8 a = randQMat<13, 70>();
+    lia::DMati8 b = randQMat<70, 11>();
+    lia::DMati c(13, 11);
+    lia::dot(c, a, b);
+    for (int i = 0; i < 13; i++) {
+        for (int j = 0; j < 11; j++) {
+            int sum = 0;
+            for (int k = 0; k < 70; k++) {
+                sum += a(i, k) * b(k, j);
+            }
+            if (c(i, j) != sum) { throw std::runtime_error(""); }
+        }
+    }
+
+    // Worst case accumulation at the largest supported inner dimension, anything larger is rejected
+    lia::DMati8 l(1, 65535), r(65535, 1);
+    for (int k = 0; k < 65535; k++) {
+        l[k] = -128;
+        r[k] = -128;
+    }
+    lia::DMati d(1, 1);
+    lia::dot(d, l, r);
+    if (d[0] != 16384*65535) { throw std::runtime_error("Worst case"); }
+    lia::DMati8 l2(1, 65536), r2(65536, 1);
+    bool thrown = false;
+    try { lia::dot(d, l2, r2); }
+    catch (const std::invalid_argument& e) { thrown = true; }
+    if (!thrown) { throw std::runtime_error("Bound"); }
+})
+
+UT("Dynamic Quantized Dot(Zero Points)", {
+    lia::DMati8 a = randQMat<9, 45>();
+    lia::DMati8 b = randQMat<45, 7>();
+    lia::DVecf as(9), bs(7);
+    lia::DVeci az(9), bz(7);
+    randQParams<9>(as, az);
+    randQParams<7>(bs, bz);
+    lia::DMati c(9, 7);
+    lia::dot(c, a, lia::QParams(as, az), b, lia::QParams(bs, bz));
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 7; j++) {
+            int sum = 0;
+            for (int k = 0; k < 45; k++) {
+                sum += (a(i, k) - az[i]) * (b(k, j) - bz[j]);
+            }
+            if (c(i, j) != sum) { throw std::runtime_error(""); }
+        }
+    }
+})
+
+UT("Dynamic Quantized Dot(Layouts)", {
+    lia::DMati8 a = randQMat<9, 45>();
+    lia::DMati8 b = randQMat<45, 7>();
+    lia::DVecf as(9), bs(7);
+    lia::DVeci az(9), bz(7);
+    randQParams<9>(as, az);
+    randQParams<7>(bs, bz);
+    lia::DMati ref(9, 7);
+    lia::dot(ref, a, lia::QParams(as, az), b, lia::QParams(bs, bz));
+
+    // Column-major operands and results must give the same elements
+    lia::DMati8 ac(9, 45, lia::LAYOUT_COLUMN_MAJOR), bc(45, 7, lia::LAYOUT_COLUMN_MAJOR);
+    for (int i = 0; i < 9; i++) {
+        for (int k = 0; k < 45; k++) { ac(i, k) = a(i, k); }
+    }
+    for (int k = 0; k < 45; k++) {
+        for (int j = 0; j < 7; j++) { bc(k, j) = b(k, j); }
+    }
+    lia::DMati c(9, 7, lia::LAYOUT_COLUMN_MAJOR);
+    lia::dot(c, ac, lia::QParams(as, az), bc, lia::QParams(bs, bz));
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 7; j++) {
+            if (c(i, j) != ref(i, j)) { throw std::runtime_error(""); }
+        }
+    }
+})
+
+UT("Dynamic Quantized Dot(Dequantize)", {
+    lia::DMati8 a = randQMat<10, 33>();
+    lia::DMati8 b = randQMat<33, 6>();
+    lia::DVecf bs(6);
+    lia::DVeci bz(6);
+    randQParams<6>(bs, bz);
+    lia::DMatf c(10, 6);
+    lia::dot(c, a, lia::QParams(0.5f, 3), b, lia::QParams(bs, bz));
+    for (int i = 0; i < 10; i++) {
+        for (int j = 0; j < 6; j++) {
+            int sum = 0;
+            for (int k = 0; k < 33; k++) {
+                sum += (a(i, k) - 3) * (b(k, j) - bz[j]);
+            }
+            if (c(i, j) != 0.5f * bs[j] * (float)sum) { throw std::runtime_error(""); }
+        }
+    }
+})
+
+UT("Dynamic Quantized Dot(Requantize)", {
+    lia::DMati8 a = randQMat<8, 40>();
+    lia::DMati8 b = randQMat<40, 5>();
+    lia::DVecf as(8);
+    lia::DVeci az(8);
+    randQParams<8>(as, az);
+    lia::QParams rq(100.0f, -5);
+    lia::DMati8 c(8, 5);
+    lia::dot(c, rq, a, lia::QParams(as, az), b, lia::QParams(0.25f, 0));
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 5; j++) {
+            int sum = 0;
+            for (int k = 0; k < 40; k++) {
+                sum += (a(i, k) - az[i]) * b(k, j);
+            }
+            int q = (int)lrintf((float)sum * (as[i] * 0.25f / 100.0f)) - 5;
+            q = std::clamp(q, -128, 127);
+            if (c(i, j) != q) { throw std::runtime_error(""); }
+        }
+    }
+})
+
+UT("Dynamic Alloc Policies", {
+    const lia::Alloc policies[6] = {
+        lia::ALLOC_DEFAULT, lia::ALLOC_HEAP, lia::ALLOC_TRANSPARENT_HUGE_PAGES,
+        lia::ALLOC_HUGE_PAGES, lia::ALLOC_NUMA_INTERLEAVE, lia::ALLOC_NUMA_FIRST_TOUCH
+    };
+    lia::DMatd b = randMat<300, 200>();
+    for (lia::Alloc policy : policies) {
+        lia::DMatd a(400, 300, policy);
+        lia::clear(a, 0.5);
+        lia::DMatd c(400, 200, policy);
+        lia::dot(c, a, b);
+        lia::DMatd d = c;
+        if (d.alloc() != c.alloc()) { throw std::runtime_error("Copy changed the policy"); }
+        for (int i = 0; i < 400; i++) {
+            for (int j = 0; j < 200; j++) {
+                double sum = 0.0;
+                for (int k = 0; k < 300; k++) {
+                    sum += 0.5 * b(k, j);
+                }
+                if (d(i, j) != sum) { throw std::runtime_error(""); }
+            }
+        }
+    }
+})
+
+UT("Dynamic Alloc NUMA Fallback", {
+    // Without several nodes the NUMA policies must report the mapping actually used
+    if (lia::numaNodes() > 1) { return; }
+    const lia::Alloc policies[2] = { lia::ALLOC_NUMA_INTERLEAVE, lia::ALLOC_NUMA_FIRST_TOUCH };
+    for (lia::Alloc policy : policies) {
+        lia::DMatd a(400, 300, policy);
+        if (a.alloc() != lia::ALLOC_HEAP) { throw std::runtime_error("Small buffer not on the heap"); }
+        lia::DMatd b(1000, 600, policy);
+        if (b.alloc() != lia::ALLOC_TRANSPARENT_HUGE_PAGES) { throw std::runtime_error("Large buffer not reported as huge pages"); }
+        lia::clear(b, 1.0);
+        if (b[0] != 1.0 || b[1000*600 - 1] != 1.0) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Dynamic Alloc Huge Pages", {
+    // Large matrices must resolve the default policy
+    lia::DMatd a(1000, 600);
+    if (a.alloc() == lia::ALLOC_DEFAULT) { throw std::runtime_error("Policy not resolved"); }
+    if (a.alloc() == lia::ALLOC_TRANSPARENT_HUGE_PAGES && (uintptr_t)a.data() % (2 << 20)) {
+        throw std::runtime_error("Buffer not aligned to a huge page");
+    }
+    lia::clear(a, 1.0);
+    for (int i = 0; i < 1000*600; i++) {
+        if (a[i] != 1.0) { throw std::runtime_error(""); }
+    }
+
+    // Small matrices must stay on the heap
+    lia::DMatd b(10, 10);
+    if (b.alloc() != lia::ALLOC_HEAP) { throw std::runtime_error("Small matrix not on the heap"); }
+})
+
+UT("Dynamic Resize", {
+    // Growing reallocates and keeps the elements in order
+    lia::DMatd a(20, 30);
+    for (int i = 0; i < 600; i++) { a[i] = i; }
+    a.resize(40, 30);
+    if (a.ls != 40 || a.cs != 30 || a.capacity() < 1200) { throw std::runtime_error("Wrong size"); }
+    for (int i = 0; i < 600; i++) {
+        if (a[i] != i) { throw std::runtime_error("Elements not kept"); }
+    }
+
+    // Shrinking keeps the buffer
+    const double* data = a.data();
+    const int capacity = a.capacity();
+    a.resize(20, 20);
+    if (a.data() != data || a.capacity() != capacity) { throw std::runtime_error("Buffer reallocated"); }
+
+    // Reserving ahead avoids reallocations
+    lia::DVecd v(1);
+    v.reserve(100);
+    data = v.data();
+    for (int i = 1; i <= 100; i++) {
+        v.resize(i);
+        v[i-1] = i;
+    }
+    if (v.data() != data) { throw std::runtime_error("Buffer reallocated"); }
+    for (int i = 0; i < 100; i++) {
+        if (v[i] != i + 1) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Dynamic Reserve Failure", {
+    // A failed reservation must leave the matrix untouched
+    lia::DMatd a(20, 30);
+    for (int i = 0; i < 600; i++) { a[i] = i; }
+    const double* data = a.data();
+    const int capacity = a.capacity();
+    try {
+        a.reserve(INT_MAX);
+        if (a.capacity() < INT_MAX) { throw std::runtime_error("Wrong capacity"); }
+        return;
+    }
+    catch (const std::bad_alloc& e) {}
+    if (a.data() != data || a.capacity() != capacity || a.alloc() == lia::ALLOC_INLINE) {
+        throw std::runtime_error("Matrix changed");
+    }
+    a.resize(30, 20);
+    for (int i = 0; i < 600; i++) {
+        if (a[i] != i) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Dynamic Reshape", {
+    lia::DMatd a(2, 6);
+    for (int i = 0; i < 12; i++) { a[i] = i; }
+    const double* data = a.data();
+    a.reshape(3, 4);
+    if (a.ls != 3 || a.cs != 4 || a.data() != data) { throw std::runtime_error("Wrong shape"); }
+    if (a(1, 0) != 4 || a(2, 3) != 11) { throw std::runtime_error(""); }
+
+    bool thrown = false;
+    try { a.reshape(5, 5); } catch (const std::invalid_argument& e) { thrown = true; }
+    if (!thrown || a.ls != 3 || a.cs != 4) { throw std::runtime_error("Invalid reshape accepted"); }
+})
+
+UT("Dynamic Assignment", {
+    lia::DMatd a(5, 5);
+    for (int i = 0; i < 25; i++) { a[i] = i; }
+
+    // Copying into a large enough matrix reuses its buffer
+    lia::DMatd b(6, 6);
+    const double* data = b.data();
+    b = a;
+    if (b.data() != data || b.ls != 5 || b.cs != 5) { throw std::runtime_error("Buffer not reused"); }
+    for (int i = 0; i < 25; i++) {
+        if (b[i] != i) { throw std::runtime_error(""); }
+    }
+
+    // Copying into a smaller one grows it
+    lia::DMatd c(1, 1);
+    c = a;
+    for (int i = 0; i < 25; i++) {
+        if (c[i] != i) { throw std::runtime_error(""); }
+    }
+
+    // Moving steals the buffer
+    data = a.data();
+    lia::DMatd d;
+    d = std::move(a);
+    if (d.data() != data || d.ls != 5 || d.cs != 5) { throw std::runtime_error("Buffer not moved"); }
+
+    // A view can be assigned to and copies into its buffer
+    double buf[25];
+    lia::DMatd view(5, 5, buf);
+    view = d;
+    if (view.data() != buf || buf[24] != 24) { throw std::runtime_error("View not written"); }
+})
+
+UT("Dynamic Inline Storage", {
+    // Small matrices live inside the object
+    lia::DVecd a(LIA_DMAT_INLINE_SIZE);
+    if (a.alloc() != lia::ALLOC_INLINE) { throw std::runtime_error("Small vector not inline"); }
+    if ((const uint8_t*)a.data() < (const uint8_t*)&a || (const uint8_t*)a.data() >= (const uint8_t*)(&a + 1)) {
+        throw std::runtime_error("Data not inside the object");
+    }
+    for (int i = 0; i < LIA_DMAT_INLINE_SIZE; i++) { a[i] = i; }
+
+    // Copies and moves must point to their own inline buffer
+    lia::DVecd b = a;
+    lia::DVecd c = std::move(b);
+    lia::DVecd d(3);
+    d = std::move(c);
+    if (d.data() == a.data() || d.alloc() != lia::ALLOC_INLINE || d.ls != LIA_DMAT_INLINE_SIZE) {
+        throw std::runtime_error("Inline buffer shared");
+    }
+    for (int i = 0; i < LIA_DMAT_INLINE_SIZE; i++) {
+        if (d[i] != i) { throw std::runtime_error(""); }
+    }
+
+    // Growing past the inline buffer moves to the heap
+    d.resize(LIA_DMAT_INLINE_SIZE + 1);
+    if (d.alloc() != lia::ALLOC_HEAP) { throw std::runtime_error("Large vector not on the heap"); }
+    for (int i = 0; i < LIA_DMAT_INLINE_SIZE; i++) {
+        if (d[i] != i) { throw std::runtime_error(""); }
+    }
+
+    // Explicit mapped policies are never inline
+    lia::DMatd e(2, 2, lia::ALLOC_NUMA_INTERLEAVE);
+    if (e.alloc() == lia::ALLOC_INLINE) { throw std::runtime_error("Policy ignored"); }
+})
+
+template <int L, int I, int C>
+static void checkBatch(int count) {
+    // Build the batch and its reference results
+    std::vector<lia::DMatd> lefts, rights, refs;
+    for (int n = 0; n < count; n++) {
+        lefts.push_back(randMat<L, I>());
+        rights.push_back(randMat<I, C>());
+        refs.push_back(lia::DMatd(L, C));
+        lia::dot(refs[n], lefts[n], rights[n]);
+    }
+
+    // Strided form
+    std::vector<double> a(count*L*I), b(count*I*C), r(count*L*C);
+    for (int n = 0; n < count; n++) {
+        memcpy(&a[n*L*I], lefts[n].data(), L*I*sizeof(double));
+        memcpy(&b[n*I*C], rights[n].data(), I*C*sizeof(double));
+    }
+    lia::dot(r.data(), L*C, a.data(), L*I, b.data(), I*C, count, L, I, C);
+    for (int n = 0; n < count; n++) {
+        if (memcmp(&r[n*L*C], refs[n].data(), L*C*sizeof(double))) { throw std::runtime_error("Strided batch mismatch"); }
+    }
+
+    // Pointer array form
+    std::vector<lia::DMatd> results(count, lia::DMatd(L, C));
+    std::vector<double*> rp(count);
+    std::vector<const double*> ap(count), bp(count);
+    for (int n = 0; n < count; n++) {
+        rp[n] = results[n].data();
+        ap[n] = lefts[n].data();
+        bp[n] = rights[n].data();
+    }
+    lia::dot(rp.data(), ap.data(), bp.data(), count, L, I, C);
+    for (int n = 0; n < count; n++) {
+        if (memcmp(results[n].data(), refs[n].data(), L*C*sizeof(double))) { throw std::runtime_error("Pointer batch mismatch"); }
+    }
+}
+
+UT("Dynamic Batched Dot", {
+    checkBatch<3, 3, 3>(100);
+    checkBatch<8, 8, 8>(500);
+    checkBatch<13, 13, 13>(50);
+    checkBatch<64, 64, 64>(20);
+    checkBatch<5, 7, 2>(30);
+
+    // A zero stride shares the right-hand matrix
+    lia::DMatd a = randMat<8, 8>();
+    lia::DMatd b = randMat<8, 8>();
+    lia::DMatd ref(8, 8);
+    lia::dot(ref, a, b);
+    std::vector<double> r(10*64);
+    lia::dot(r.data(), 64, a.data(), 0, b.data(), 0, 10, 8, 8, 8);
+    for (int n = 0; n < 10; n++) {
+        if (memcmp(&r[n*64], ref.data(), 64*sizeof(double))) { throw std::runtime_error("Shared operand mismatch"); }
+    }
+})
+
+UT("Dynamic Normalize/Distance", {
+    lia::DVecd a = randVec<42>();
+    lia::DVecd b = randVec<42>();
+    lia::DVecd u(42);
+    lia::normalize(u, a);
+    if (fabs(lia::norm(u) - 1.0) > 1e-15) { throw std::runtime_error("Normalize"); }
+
+    lia::DVecd diff(42);
+    lia::sub(diff, a, b);
+    const double n = lia::norm(diff);
+    if (fabs(lia::distance(a, b) - n) > 1e-15 || fabs(lia::distance2(a, b) - n*n) > 1e-14) { throw std::runtime_error("Distance"); }
+})
+
+template <int n>
+static inline void checkStrassen(bool workspace) {
+    lia::DMatd a = randMat<n, n>();
+    lia::DMatd b = randMat<n, n>();
+    lia::DMatd ref(n, n), c(n, n);
+    lia::dot(ref, a, b);
+    std::vector<double> work(lia::strassenWorkspace(n));
+    lia::dot(c, a, b, lia::DOT_STRASSEN, workspace ? work.data() : NULL);
+    const double bound = lia::dotErrorBound(a, b, lia::DOT_STRASSEN);
+    if (bound < lia::dotErrorBound(a, b, lia::DOT_CLASSICAL)) { throw std::runtime_error("Bound"); }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (fabs(c(i, j) - ref(i, j)) > bound) { throw std::runtime_error("Accuracy"); }
+        }
+    }
+}
+
+UT("Dynamic Strassen Dot", {
+    checkStrassen<64>(false);
+    checkStrassen<300>(true);
+    checkStrassen<301>(false);
+    checkStrassen<517>(true);
+
+    // Integer products are exact
+    lia::DMati a(259, 259), b(259, 259), ref(259, 259), c(259, 259);
+    for (int i = 0; i < 259*259; i++) {
+        a[i] = rand() % 100 - 50;
+        b[i] = rand() % 100 - 50;
+    }
+    lia::dot(ref, a, b);
+    lia::dot(c, a, b, lia::DOT_STRASSEN);
+    if (memcmp(c.data(), ref.data(), sizeof(int)*259*259)) { throw std::runtime_error("Integer"); }
+
+    // Non-square products fall back to the classical algorithm
+    lia::DMatd x = randMat<69, 42>();
+    lia::DMatd y = randMat<42, 52>();
+    lia::DMatd z1(69, 52), z2(69, 52);
+    lia::dot(z1, x, y);
+    lia::dot(z2, x, y, lia::DOT_STRASSEN);
+    if (memcmp(z1.data(), z2.data(), sizeof(double)*69*52)) { throw std::runtime_error("Fallback"); }
+})
+
+UT("Dynamic Dot Transposed", {
+    lia::DMatd a = randMat<42, 69>();
+    lia::DMatd b = randMat<42, 52>();
+    lia::DMatd c = randMat<52, 69>();
+    lia::DMatd at(69, 42), ct(69, 52);
+    lia::transpose(at, a);
+    lia::transpose(ct, c);
+
+    // Every combination must match the product of the materialized transposes bit for bit
+    lia::DMatd ref(69, 52), r(69, 52);
+    lia::dot(ref, at, b);
+    lia::dot(r, a, true, b, false);
+    if (memcmp(r.data(), ref.data(), sizeof(double)*69*52)) { throw std::runtime_error("A^T*B"); }
+
+    lia::DMatd ref2(69, 69), r2(69, 69);
+    lia::dot(ref2, ct, c);
+    lia::dot(r2, ct, false, ct, true);
+    if (memcmp(r2.data(), ref2.data(), sizeof(double)*69*69)) { throw std::runtime_error("A*B^T"); }
+
+    lia::DMatd ref3(69, 52), r3(69, 52);
+    lia::dot(ref3, at, b);
+    lia::DMatd bt(52, 42);
+    lia::transpose(bt, b);
+    lia::dot(r3, a, true, bt, true);
+    if (memcmp(r3.data(), ref3.data(), sizeof(double)*69*52)) { throw std::runtime_error("A^T*B^T"); }
+})
+
+UT("Dynamic Gram/Ger", {
+    lia::DMatd a = randMat<69, 42>();
+    lia::DMatd at(42, 69), ref(42, 42), g(42, 42);
+    lia::transpose(at, a);
+    lia::dot(ref, at, a);
+    lia::gram(g, a);
+    for (int i = 0; i < 42; i++) {
+        for (int j = 0; j < 42; j++) {
+            if (fabs(g(i, j) - ref(i, j)) > 1e-12 || g(i, j) != g(j, i)) { throw std::runtime_error("Gram"); }
+        }
+    }
+
+    // Single triangles must leave the other one untouched
+    lia::DMatd lo(42, 42), up(42, 42);
+    lia::clear(lo, -1.0);
+    lia::clear(up, -1.0);
+    lia::gram(lo, a, lia::UPLO_LOWER);
+    lia::gram(up, a, lia::UPLO_UPPER);
+    for (int i = 0; i < 42; i++) {
+        for (int j = 0; j < 42; j++) {
+            if (j <= i && lo(i, j) != g(i, j)) { throw std::runtime_error("Lower"); }
+            if (j > i && lo(i, j) != -1.0) { throw std::runtime_error("Lower untouched"); }
+            if (j >= i && fabs(up(i, j) - ref(i, j)) > 1e-12) { throw std::runtime_error("Upper"); }
+            if (j < i && up(i, j) != -1.0) { throw std::runtime_error("Upper untouched"); }
+        }
+    }
+
+    lia::DVecd x = randVec<69>();
+    lia::DVecd y = randVec<42>();
+    lia::DMatd u = a;
+    lia::ger(u, x, y, 0.5);
+    for (int i = 0; i < 69; i++) {
+        for (int j = 0; j < 42; j++) {
+            if (fabs(u(i, j) - (a(i, j) + 0.5*x[i]*y[j])) > 1e-15) { throw std::runtime_error("Ger"); }
+        }
+    }
+})
+
+UT("Dynamic Tdot/Gemv", {
+    lia::DMatd a = randMat<300, 200>();
+    lia::DMatd at(200, 300);
+    lia::transpose(at, a);
+    lia::DVecd x = randVec<300>();
+    lia::DVecd z = randVec<200>();
+
+    // Transposed product against the materialized transpose
+    lia::DVecd ref(200), r(200);
+    lia::dot(ref, at, x);
+    lia::tdot(r, a, x);
+    for (int i = 0; i < 200; i++) {
+        if (fabs(r[i] - ref[i]) > 1e-12) { throw std::runtime_error("Tdot"); }
+    }
+
+    // Fused updates in both orientations
+    lia::DVecd y = randVec<200>();
+    lia::DVecd y0 = y;
+    lia::gemv(y, a, true, x, 2.0, 0.5);
+    for (int i = 0; i < 200; i++) {
+        if (fabs(y[i] - (2.0*ref[i] + 0.5*y0[i])) > 1e-12) { throw std::runtime_error("Gemv transposed"); }
+    }
+    lia::DVecd w = randVec<300>();
+    lia::DVecd w0 = w;
+    lia::DVecd ref2(300);
+    lia::dot(ref2, a, z);
+    lia::gemv(w, a, false, z, -1.0, 3.0);
+    for (int i = 0; i < 300; i++) {
+        if (fabs(w[i] - (3.0*w0[i] - ref2[i])) > 1e-12) { throw std::runtime_error("Gemv"); }
+    }
+
+    // A zero beta ignores whatever the result held
+    lia::DVecd n(300);
+    for (int i = 0; i < 300; i++) { n[i] = NAN; }
+    lia::gemv(n, a, false, z, 1.0, 0.0);
+    if (isnan(n[0])) { throw std::runtime_error("Beta"); }
+})
+
+template <int ls, int cs>
+static inline lia::DMatd colMajor(const lia::DMatd& value) {
+    lia::DMatd mat(ls, cs, lia::LAYOUT_COLUMN_MAJOR);
+    for (int i = 0; i < ls; i++) {
+        for (int j = 0; j < cs; j++) { mat(i, j) = value(i, j); }
+    }
+    return mat;
+}
+
+static inline void checkSame(const lia::DMatd& a, const lia::DMatd& b, double tol) {
+    for (int i = 0; i < a.ls; i++) {
+        for (int j = 0; j < a.cs; j++) {
+            if (fabs(a(i, j) - b(i, j)) > tol) { throw std::runtime_error(""); }
+        }
+    }
+}
+
+UT("Dynamic Layout Storage", {
+    double buffer[6] = { 1, 2, 3, 4, 5, 6 };
+    lia::DMatd view(2, 3, buffer, lia::LAYOUT_COLUMN_MAJOR);
+    if (view(0, 1) != 3.0 || view(1, 2) != 6.0 || view.layout() != lia::LAYOUT_COLUMN_MAJOR) { throw std::runtime_error("View"); }
+
+    // Copies keep the layout
+    lia::DMatd copy = view;
+    lia::DMatd assigned;
+    assigned = view;
+    if (copy.layout() != lia::LAYOUT_COLUMN_MAJOR || assigned.layout() != lia::LAYOUT_COLUMN_MAJOR) { throw std::runtime_error("Copy"); }
+    checkSame(copy, view, 0.0);
+    checkSame(assigned, view, 0.0);
+
+    // Transposing across layouts shares the storage order, within a layout it moves the elements
+    lia::DMatd a = randMat<69, 42>();
+    lia::DMatd ac = colMajor<69, 42>(a);
+    lia::DMatd ref(42, 69), t1(42, 69), t2(42, 69, lia::LAYOUT_COLUMN_MAJOR);
+    lia::transpose(ref, a);
+    lia::transpose(t1, ac);
+    lia::transpose(t2, ac);
+    checkSame(t1, ref, 0.0);
+    checkSame(t2, ref, 0.0);
+})
+
+UT("Dynamic Layout Element-wise", {
+    lia::DMatd a = randMat<69, 42>();
+    lia::DMatd b = randMat<69, 42>();
+    lia::DMatd bc = colMajor<69, 42>(b);
+    lia::DMatd ref(69, 42), r(69, 42), rc(69, 42, lia::LAYOUT_COLUMN_MAJOR);
+
+    lia::add(ref, a, b);
+    lia::add(r, a, bc);
+    lia::add(rc, a, bc);
+    checkSame(r, ref, 0.0);
+    checkSame(rc, ref, 0.0);
+
+    lia::sub(ref, a, b);
+    lia::sub(rc, a, b);
+    checkSame(rc, ref, 0.0);
+
+    lia::mul(ref, b, 3.0);
+    lia::mul(r, bc, 3.0);
+    checkSame(r, ref, 0.0);
+
+    lia::div(ref, b, 3.0);
+    lia::div(rc, b, 3.0);
+    checkSame(rc, ref, 0.0);
+
+    lia::DMatf f(69, 42);
+    lia::cast(f, bc);
+    for (int i = 0; i < 69; i++) {
+        for (int j = 0; j < 42; j++) {
+            if (f(i, j) != (float)b(i, j)) { throw std::runtime_error("Cast"); }
+        }
+    }
+})
+
+UT("Dynamic Layout Dot", {
+    lia::DMatd a = randMat<69, 42>();
+    lia::DMatd b = randMat<42, 52>();
+    lia::DMatd ac = colMajor<69, 42>(a);
+    lia::DMatd bc = colMajor<42, 52>(b);
+    lia::DMatd ref(69, 52);
+    lia::dot(ref, a, b);
+
+    // Every mix of operand and result layouts
+    for (int mode = 0; mode < 8; mode++) {
+        lia::DMatd r(69, 52, (mode & 4) ? lia::LAYOUT_COLUMN_MAJOR : lia::LAYOUT_ROW_MAJOR);
+        lia::dot(r, (mode & 1) ? ac : a, (mode & 2) ? bc : b);
+        checkSame(r, ref, 1e-12);
+    }
+
+    // Transposed flags compose with the layout
+    lia::DMatd at(42, 69);
+    lia::transpose(at, a);
+    lia::DMatd atc = colMajor<42, 69>(at);
+    lia::DMatd r(69, 52, lia::LAYOUT_COLUMN_MAJOR);
+    lia::dot(r, atc, true, b, false);
+    checkSame(r, ref, 1e-12);
+
+    // Matrix-vector products
+    lia::DVecd x = randVec<42>();
+    lia::DVecd y = randVec<69>();
+    lia::DVecd vref(69), v(69), tref(42), t(42);
+    lia::dot(vref, a, x);
+    lia::dot(v, ac, x);
+    checkSame(v, vref, 1e-12);
+    lia::tdot(tref, a, y);
+    lia::tdot(t, ac, y);
+    checkSame(t, tref, 1e-12);
+
+    // Rank updates
+    lia::DMatd g(42, 42), gref(42, 42);
+    lia::gram(gref, a);
+    lia::gram(g, ac);
+    checkSame(g, gref, 1e-12);
+    lia::DMatd gc(42, 42, lia::LAYOUT_COLUMN_MAJOR);
+    lia::clear(gc, 0.0);
+    lia::gram(gc, ac, lia::UPLO_UPPER);
+    for (int i = 0; i < 42; i++) {
+        for (int j = 0; j < 42; j++) {
+            if (j >= i && fabs(gc(i, j) - gref(i, j)) > 1e-12) { throw std::runtime_error("Gram upper"); }
+            if (j < i && gc(i, j) != 0.0) { throw std::runtime_error("Gram lower untouched"); }
+        }
+    }
+    lia::ger(a, y, x, 2.0);
+    lia::ger(ac, y, x, 2.0);
+    checkSame(ac, a, 1e-15);
+})
+
+// Pairwise sum of the block partials, the documented order of the reproducible reductions
+static inline float pairwise(const float* partials, int count) {
+    if (count == 1) { return partials[0]; }
+    return pairwise(partials, count / 2) + pairwise(&partials[count / 2], count - count / 2);
+}
+
+UT("Dynamic Reproducible Reductions", {
+    const int d = 1000003;
+    const int block = 4096;
+    lia::DVecf a(d);
+    lia::DVecf b(d);
+    double ref = 0.0;
+    for (int i = 0; i < d; i++) {
+        a[i] = (float)rand() / (float)RAND_MAX - 0.5f;
+        b[i] = (float)rand() / (float)RAND_MAX;
+        ref += (double)a[i]*b[i];
+    }
+
+    // The result must be made of whole blocks combined by the fixed tree, whatever the number of threads
+    float r;
+    lia::dot(r, a, b, lia::REDUCE_REPRODUCIBLE);
+    std::vector<float> partials;
+    for (int i = 0; i < d; i += block) {
+        const int n = std::min(block, d - i);
+        lia::DVecf sa(n, &a[i]);
+        lia::DVecf sb(n, &b[i]);
+        float p;
+        lia::dot(p, sa, sb, lia::REDUCE_REPRODUCIBLE);
+        partials.push_back(p);
+    }
+    if (r != pairwise(partials.data(), (int)partials.size())) { throw std::runtime_error("Dot order"); }
+    if (fabs(r - ref) > 1e-3) { throw std::runtime_error("Dot"); }
+
+    float f;
+    lia::dot(f, a, b, lia::REDUCE_FAST);
+    if (fabs(f - ref) > 1e-2) { throw std::runtime_error("Fast dot"); }
+
+    const float n = lia::norm(a, lia::REDUCE_REPRODUCIBLE);
+    float n2;
+    lia::dot(n2, a, a, lia::REDUCE_REPRODUCIBLE);
+    if (n != sqrtf(n2)) { throw std::runtime_error("Norm"); }
+})
+
+static_assert(std::is_nothrow_move_constructible<lia::DMatd>::value, "DMat moves must be noexcept");
+static_assert(std::is_nothrow_move_assignable<lia::DMatd>::value, "DMat moves must be noexcept");
+
+UT("Dynamic Move In Vector", {
+    // Growing a vector must move the matrices rather than copy them, keeping their buffers
+    std::vector<lia::DMatd> mats;
+    std::vector<const double*> buffers;
+    for (int i = 0; i < 33; i++) {
+        mats.push_back(lia::DMatd(100, 100));
+        buffers.push_back(mats.back().data());
+    }
+    for (int i = 0; i < 33; i++) {
+        if (mats[i].data() != buffers[i]) { throw std::runtime_error(""); }
+    }
+})
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "../utt/utt.h"
+#include "../../lia/dense/elementwise.h"
+#include <float.h>
+#include <string.h>
+
+template <typename T>
+static inline void fillRandom(lia::DMat<T>& m, T low, T high) {
+    for (int i = 0; i < m.ls; i++) {
+        for (int j = 0; j < m.cs; j++) { m(i, j) = low + (high - low) * (T)rand() / (T)RAND_MAX; }
+    }
+}
+
+UT("Elementwise Math Accuracy", {
+    // Sweep the ranges through the vectorized path with a tail that goes through the scalar one
+    const int count = 100003;
+    lia::DMatf x(1, count);
+    lia::DMatf y(1, count);
+
+    // Exponential, relative error for normal results and one subnormal step below
+    for (int i = 0; i < count; i++) { x[i] = -103.9f + 192.6f * (float)i / (float)count; }
+    lia::map(y, x, lia::Exp());
+    for (int i = 0; i < count; i++) {
+        const double ref = exp((double)x[i]);
+        const double tol = (ref < FLT_MIN) ? ldexp(1.0, -149) : 2e-7 * ref;
+        if (fabs(y[i] - ref) > tol) { throw std::runtime_error("Exp"); }
+    }
+
+    // Logarithm, mixed absolute and relative error
+    for (int i = 0; i < count; i++) { x[i] = ldexpf(1.0f + (float)i / (float)count, i % 200 - 100); }
+    lia::map(y, x, lia::Log());
+    for (int i = 0; i < count; i++) {
+        const double ref = log((double)x[i]);
+        if (fabs(y[i] - ref) > 2e-7 + 2e-7 * fabs(ref)) { throw std::runtime_error("Log"); }
+    }
+    x[0] = 0.0f; x[1] = -1.0f; x[count - 1] = 0.0f; x[count - 2] = -1.0f;
+    lia::map(y, x, lia::Log());
+    if (y[0] != -INFINITY || !isnan(y[1]) || y[count - 1] != -INFINITY || !isnan(y[count - 2])) { throw std::runtime_error("Log domain"); }
+
+    // Logarithm of subnormals
+    for (int i = 0; i < count; i++) { x[i] = ldexpf(1.0f + (float)i / (float)count, -149 + i % 23); }
+    lia::map(y, x, lia::Log());
+    for (int i = 0; i < count; i++) {
+        const double ref = log((double)x[i]);
+        if (fabs(y[i] - ref) > 2e-7 + 2e-7 * fabs(ref)) { throw std::runtime_error("Log subnormal"); }
+    }
+
+    // Hyperbolic tangent, absolute error
+    for (int i = 0; i < count; i++) { x[i] = -12.0f + 24.0f * (float)i / (float)count; }
+    lia::map(y, x, lia::Tanh());
+    for (int i = 0; i < count; i++) {
+        if (fabs(y[i] - tanh((double)x[i])) > 3e-7) { throw std::runtime_error("Tanh"); }
+    }
+})
+
+// Apply a function to a special value through the SSE body and through the scalar tail, both must give the same bits
+template <class F>
+static inline float special(float value, F f) {
+    lia::DMatf body(1, 4), tail(1, 1), r(1, 4), rt(1, 1);
+    lia::clear(body, value);
+    lia::clear(tail, value);
+    lia::map(r, body, f);
+    lia::map(rt, tail, f);
+    if (memcmp(&r[0], &rt[0], sizeof(float)) || memcmp(&r[0], &r[3], sizeof(float))) { throw std::runtime_error("SSE and scalar disagree"); }
+    return rt[0];
+}
+
+UT("Elementwise Math Special Values", {
+    // Exponential overflow, underflow and NaN
+    if (special(INFINITY, lia::Exp()) != INFINITY || special(89.0f, lia::Exp()) != INFINITY) { throw std::runtime_error("Exp overflow"); }
+    if (fabs(special(88.72f, lia::Exp()) - exp((double)88.72f)) > 2e-7 * exp((double)88.72f)) { throw std::runtime_error("Exp largest"); }
+    if (special(-INFINITY, lia::Exp()) != 0.0f || special(-200.0f, lia::Exp()) != 0.0f) { throw std::runtime_error("Exp underflow"); }
+    if (special(-100.0f, lia::Exp()) == 0.0f) { throw std::runtime_error("Exp subnormal"); }
+    if (!isnan(special(NAN, lia::Exp()))) { throw std::runtime_error("Exp NaN"); }
+
+    // Logarithm domain
+    if (special(INFINITY, lia::Log()) != INFINITY || special(-0.0f, lia::Log()) != -INFINITY) { throw std::runtime_error("Log inf"); }
+    if (!isnan(special(NAN, lia::Log())) || !isnan(special(-INFINITY, lia::Log()))) { throw std::runtime_error("Log NaN"); }
+    if (fabs(special(1e-40f, lia::Log()) - log((double)1e-40f)) > 2e-5) { throw std::runtime_error("Log subnormal"); }
+    if (fabs(special(FLT_MAX, lia::Log()) - log((double)FLT_MAX)) > 2e-5) { throw std::runtime_error("Log largest"); }
+
+    // Hyperbolic tangent saturation and NaN
+    if (special(INFINITY, lia::Tanh()) != 1.0f || special(-INFINITY, lia::Tanh()) != -1.0f) { throw std::runtime_error("Tanh inf"); }
+    if (!isnan(special(NAN, lia::Tanh()))) { throw std::runtime_error("Tanh NaN"); }
+
+    // Absolute value must clear the sign of zeros and NaNs
+    if (signbit(special(-0.0f, lia::Abs())) || special(-INFINITY, lia::Abs()) != INFINITY) { throw std::runtime_error("Abs zero"); }
+    if (!isnan(special(-NAN, lia::Abs())) || signbit(special(-NAN, lia::Abs()))) { throw std::runtime_error("Abs NaN"); }
+    if (special(-1e-40f, lia::Abs()) != 1e-40f) { throw std::runtime_error("Abs subnormal"); }
+
+    // Clamping keeps signed zeros and propagates NaN
+    const lia::Clamp<float> clamp(0.0f, 1.0f);
+    if (!signbit(special(-0.0f, clamp)) || special(INFINITY, clamp) != 1.0f || special(-INFINITY, clamp) != 0.0f) { throw std::runtime_error("Clamp inf"); }
+    if (!isnan(special(NAN, clamp))) { throw std::runtime_error("Clamp NaN"); }
+})
+
+UT("Elementwise Map/Zip", {
+    for (int cs : { 1, 7, 64 }) {
+        lia::DMatf a(13, cs);
+        lia::DMatf b(13, cs);
+        lia::DMatf r(13, cs);
+        fillRandom(a, -2.0f, 2.0f);
+        fillRandom(b, -2.0f, 2.0f);
+
+        lia::map(r, a, lia::Clamp<float>(-1.0f, 0.5f));
+        for (int i = 0; i < a.ls*a.cs; i++) {
+            if (r[i] != std::min(std::max(a[i], -1.0f), 0.5f)) { throw std::runtime_error("Clamp"); }
+        }
+        lia::map(r, a, lia::Abs());
+        for (int i = 0; i < a.ls*a.cs; i++) {
+            if (r[i] != fabsf(a[i])) { throw std::runtime_error("Abs"); }
+        }
+        lia::zip(r, a, b, lia::Max());
+        for (int i = 0; i < a.ls*a.cs; i++) {
+            if (r[i] != std::max(a[i], b[i])) { throw std::runtime_error("Zip max"); }
+        }
+
+        // Arbitrary lambdas and conversions
+        lia::DMatd rd(13, cs);
+        lia::zip(rd, a, b, [](float x, float y) { return (double)x * y + 1.0; });
+        for (int i = 0; i < a.ls*a.cs; i++) {
+            if (rd[i] != (double)a[i] * b[i] + 1.0) { throw std::runtime_error("Zip lambda"); }
+        }
+    }
+
+    // Mixed layouts go element by element
+    lia::DMatd a(9, 5);
+    lia::DMatd b(9, 5, lia::LAYOUT_COLUMN_MAJOR);
+    lia::DMatd r(9, 5);
+    fillRandom(a, -1.0, 1.0);
+    fillRandom(b, -1.0, 1.0);
+    lia::zip(r, a, b, lia::Min());
+    lia::DMatd e(9, 5, lia::LAYOUT_COLUMN_MAJOR);
+    lia::map(e, a, lia::Exp());
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 5; j++) {
+            if (r(i, j) != std::min(a(i, j), b(i, j))) { throw std::runtime_error("Mixed zip"); }
+            if (e(i, j) != exp(a(i, j))) { throw std::runtime_error("Mixed map"); }
+        }
+    }
+})
+
+template <lia::Layout layout>
+static inline void testReduce() {
+    lia::DMatf m(37, 23, layout);
+    fillRandom(m, -1.0f, 1.0f);
+    m(17, 11) = 3.0f;
+
+    double ref = 0.0;
+    float low = m[0];
+    for (int i = 0; i < m.ls*m.cs; i++) {
+        ref += m[i];
+        low = std::min(low, m[i]);
+    }
+    if (fabs(lia::sum(m) - ref) > 1e-4) { throw std::runtime_error("Sum"); }
+    if (lia::min(m) != low) { throw std::runtime_error("Min"); }
+    if (lia::max(m) != 3.0f) { throw std::runtime_error("Max"); }
+    int line, column;
+    lia::argmax(line, column, m);
+    if (line != 17 || column != 11) { throw std::runtime_error("Argmax"); }
+
+    // Line and column reductions
+    lia::DVecf lines(m.ls);
+    lia::DVecf columns(m.cs);
+    lia::reduceLines(lines, m, 0.0f, lia::Add());
+    lia::reduceColumns(columns, m, -INFINITY, lia::Max());
+    for (int i = 0; i < m.ls; i++) {
+        float s = 0.0f;
+        for (int j = 0; j < m.cs; j++) { s += m(i, j); }
+        if (fabsf(lines[i] - s) > 1e-5f) { throw std::runtime_error("Reduce lines"); }
+    }
+    for (int j = 0; j < m.cs; j++) {
+        float mx = -INFINITY;
+        for (int i = 0; i < m.ls; i++) { mx = std::max(mx, m(i, j)); }
+        if (columns[j] != mx) { throw std::runtime_error("Reduce columns"); }
+    }
+}
+
+UT("Elementwise Reduce", {
+    testReduce<lia::LAYOUT_ROW_MAJOR>();
+    testReduce<lia::LAYOUT_COLUMN_MAJOR>();
+})
+
+UT("Elementwise Static", {
+    constexpr lia::SMat<2, 3, int> m = { 4, -1, 7, 2, 9, -5 };
+    static_assert(lia::sum(m) == 16, "Sum");
+    static_assert(lia::min(m) == -5 && lia::max(m) == 9, "Min/Max");
+
+    lia::SMat<2, 3, int> r;
+    lia::map(r, m, lia::Abs());
+    lia::zip(r, r, m, [](int a, int b) { return a - b; });
+    if (r[1] != 2 || r[5] != 10 || r[0] != 0) { throw std::runtime_error("Map/Zip"); }
+
+    int line, column;
+    lia::argmax(line, column, m);
+    if (line != 1 || column != 1) { throw std::runtime_error("Argmax"); }
+    lia::SVec<2, int> lines;
+    lia::SVec<3, int> columns;
+    lia::reduceLines(lines, m, 0, lia::Add());
+    lia::reduceColumns(columns, m, 0, lia::Min());
+    if (lines[0] != 10 || lines[1] != 6) { throw std::runtime_error("Reduce lines"); }
+    if (columns[0] != 0 || columns[1] != -1 || columns[2] != -5) { throw std::runtime_error("Reduce columns"); }
+})
+
+template <lia::Layout layout>
+static inline void testBroadcast() {
+    for (int cs : { 3, 17 }) {
+        lia::DMatf a(11, cs, layout);
+        lia::DMatf b(11, cs, layout);
+        lia::DMatf r(11, cs, layout);
+        lia::DVecf lv(cs);
+        lia::DVecf cv(11);
+        fillRandom(a, -2.0f, 2.0f);
+        fillRandom(b, 0.5f, 2.0f);
+        fillRandom<float>(lv, -1.0f, 1.0f);
+        fillRandom<float>(cv, -1.0f, 1.0f);
+
+        lia::hadamard(r, a, b);
+        for (int i = 0; i < 11*cs; i++) {
+            if (r[i] != a[i] * b[i]) { throw std::runtime_error("Hadamard"); }
+        }
+        lia::ediv(r, a, b);
+        for (int i = 0; i < 11*cs; i++) {
+            if (r[i] != a[i] / b[i]) { throw std::runtime_error("Ediv"); }
+        }
+
+        lia::addLines(r, a, lv);
+        for (int i = 0; i < 11; i++) {
+            for (int j = 0; j < cs; j++) {
+                if (r(i, j) != a(i, j) + lv[j]) { throw std::runtime_error("Add lines"); }
+            }
+        }
+        lia::mulColumns(r, a, cv);
+        for (int i = 0; i < 11; i++) {
+            for (int j = 0; j < cs; j++) {
+                if (r(i, j) != a(i, j) * cv[i]) { throw std::runtime_error("Mul columns"); }
+            }
+        }
+
+        // Fused bias and activation in a single pass
+        lia::zipLines(r, a, lv, lia::vectorize([](auto x, auto bias) { return lia::Tanh()(lia::Add()(x, bias)); }));
+        for (int i = 0; i < 11; i++) {
+            for (int j = 0; j < cs; j++) {
+                if (fabsf(r(i, j) - tanhf(a(i, j) + lv[j])) > 1e-6f) { throw std::runtime_error("Fused"); }
+            }
+        }
+
+        // Different layouts for the result and the operand
+        lia::DMatf m(11, cs, (layout == lia::LAYOUT_ROW_MAJOR) ? lia::LAYOUT_COLUMN_MAJOR : lia::LAYOUT_ROW_MAJOR);
+        lia::subColumns(m, a, cv);
+        for (int i = 0; i < 11; i++) {
+            for (int j = 0; j < cs; j++) {
+                if (m(i, j) != a(i, j) - cv[i]) { throw std::runtime_error("Mixed sub columns"); }
+            }
+        }
+    }
+}
+
+UT("Elementwise Hadamard/Broadcast", {
+    testBroadcast<lia::LAYOUT_ROW_MAJOR>();
+    testBroadcast<lia::LAYOUT_COLUMN_MAJOR>();
+
+    lia::SMat<2, 3, float> a = { 1, 2, 3, 4, 5, 6 };
+    lia::SMat<2, 3, float> r;
+    lia::hadamard(r, a, a);
+    if (r[4] != 25.0f) { throw std::runtime_error("Static hadamard"); }
+    lia::addLines(r, a, lia::SVec<3, float>(10, 20, 30));
+    if (r[0] != 11.0f || r[5] != 36.0f) { throw std::runtime_error("Static add lines"); }
+    lia::mulColumns(r, a, lia::SVec<2, float>(2, -1));
+    if (r[2] != 6.0f || r[3] != -4.0f) { throw std::runtime_error("Static mul columns"); }
+})
\ No newline at end of file
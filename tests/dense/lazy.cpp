@@ -0,0 +1,87 @@
+#include "../utt/utt.h"
+#include "../../lia/dense/lazy.h"
+#include <math.h>
+
+static inline void randFill(lia::DMatd& mat) {
+    for (int i = 0; i < mat.ls*mat.cs; i++) { mat[i] = (double)rand() / (double)RAND_MAX - 0.5; }
+}
+
+static inline void checkClose(const lia::DMatd& a, const lia::DMatd& b, double tol) {
+    for (int i = 0; i < a.ls*a.cs; i++) {
+        if (fabs(a[i] - b[i]) > tol) { throw std::runtime_error(""); }
+    }
+}
+
+UT("Lazy Fused Chain", {
+    lia::DMatd a(57, 33), b(33, 41), c(57, 41);
+    lia::DVecd bias(41);
+    randFill(a); randFill(b); randFill(c); randFill(bias);
+
+    // Dot, bias, residual and scale reduced to a norm without storing anything
+    lia::Graphd g;
+    auto na = g.input(a);
+    auto nb = g.input(b);
+    auto nc = g.input(c);
+    auto nbias = g.input(bias);
+    auto y = g.mul(g.add(g.addLines(g.dot(na, nb), nbias), nc), 0.5);
+    g.sum(g.mul(nc, 2.0));
+    double n;
+    g.output(g.norm(y), n);
+    g.run();
+    if (g.passes() != 1 || g.temporaries() != 0) { throw std::runtime_error("Fusion"); }
+
+    lia::DMatd ref(57, 41), t(57, 41);
+    lia::dot(ref, a, b);
+    for (int i = 0; i < 57; i++) {
+        for (int j = 0; j < 41; j++) { t(i, j) = (ref(i, j) + bias[j] + c(i, j)) * 0.5; }
+    }
+    lia::DVecd flat(57*41, t.data());
+    if (fabs(n - lia::norm(flat)) > 1e-12) { throw std::runtime_error("Norm"); }
+
+    // Outputting the intermediate matrix keeps a single pass, the norm being taken while storing it
+    lia::DMatd out(57, 41);
+    g.output(y, out);
+    g.run();
+    if (g.passes() != 1 || g.temporaries() != 0) { throw std::runtime_error("Output fusion"); }
+    checkClose(out, t, 1e-12);
+    if (fabs(n - lia::norm(flat)) > 1e-12) { throw std::runtime_error("Output norm"); }
+})
+
+UT("Lazy Shared Values", {
+    lia::DMatd a(20, 20), x(20, 1);
+    randFill(a); randFill(x);
+
+    // Values used several times or as a second operand are stored in temporaries, the sum of A*A is taken while
+    // storing it and the matrix-vector product takes the GEMV path
+    lia::Graphd g;
+    auto na = g.input(a);
+    auto ax = g.dot(na, g.input(x));
+    auto aa = g.dot(na, na);
+    auto h = g.hadamard(g.sub(aa, na), g.sub(aa, na));
+    lia::DMatd r1(20, 1), r2(20, 20);
+    double s;
+    g.output(g.div(ax, 4.0), r1);
+    g.output(h, r2);
+    g.output(g.sum(aa), s);
+    g.run();
+    if (g.temporaries() != 2 || g.passes() != 4) { throw std::runtime_error("Schedule"); }
+
+    lia::DMatd rax(20, 1), raa(20, 20), d(20, 20);
+    lia::dot(rax, a, x);
+    lia::div(rax, rax, 4.0);
+    checkClose(r1, rax, 1e-12);
+    lia::dot(raa, a, a);
+    lia::sub(d, raa, a);
+    double rs = 0.0;
+    for (int i = 0; i < 400; i++) {
+        rs += raa[i];
+        d[i] *= d[i];
+    }
+    checkClose(r2, d, 1e-12);
+    if (fabs(s - rs) > 1e-10) { throw std::runtime_error("Sum"); }
+
+    bool thrown = false;
+    try { g.add(na, ax); }
+    catch (const std::invalid_argument& e) { thrown = true; }
+    if (!thrown) { throw std::runtime_error("Size check"); }
+})
\ No newline at end of file
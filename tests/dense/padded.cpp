@@ -0,0 +1,67 @@
+#include "../utt/utt.h"
+#include "../../lia/dense/padded.h"
+
+template <typename T>
+static inline lia::SVec<3, T> randVec() {
+    return lia::SVec<3, T>((T)rand() / (T)RAND_MAX - (T)0.5, (T)rand() / (T)RAND_MAX - (T)0.5, (T)rand() / (T)RAND_MAX - (T)0.5);
+}
+
+template <typename T>
+static inline void testPadded(T tol) {
+    static_assert(sizeof(lia::PVec3<T>) == 4*sizeof(T) && alignof(lia::PVec3<T>) == 4*sizeof(T), "Wrong layout");
+    for (int n = 0; n < 100; n++) {
+        lia::SVec<3, T> a = randVec<T>();
+        lia::SVec<3, T> b = randVec<T>();
+        lia::PVec3<T> pa = a;
+        lia::PVec3<T> pb = b;
+        pa.w = 123;
+        pb.w = -7;
+
+        // Dot, norm and cross must match the packed versions and ignore the dead lane
+        if (fabs((pa * pb) - (a * b)) > tol) { throw std::runtime_error("Dot"); }
+        if (fabs(lia::norm(pa) - lia::norm(a)) > tol) { throw std::runtime_error("Norm"); }
+        lia::PVec3<T> pc = pa ^ pb;
+        lia::SVec<3, T> c = a ^ b;
+        for (int i = 0; i < 3; i++) {
+            if (fabs(pc[i] - c[i]) > tol) { throw std::runtime_error("Cross"); }
+        }
+        if (pc.w != 0) { throw std::runtime_error("Dead lane"); }
+
+        // Normalization
+        lia::PVec3<T> u;
+        lia::normalize(u, pa);
+        if (fabs(lia::norm(u) - 1) > tol || u.w != 0) { throw std::runtime_error("Normalize"); }
+        for (int i = 0; i < 3; i++) {
+            if (fabs(u[i] - a[i] / lia::norm(a)) > tol) { throw std::runtime_error("Normalize direction"); }
+        }
+    }
+}
+
+UT("Padded Vec3 Float", { testPadded<float>(1e-6f); })
+UT("Padded Vec3 Double", { testPadded<double>(1e-12); })
+
+UT("Padded Vec3 Batch", {
+    const int count = 25;
+    lia::Vec3f a[count], b[count], back[count];
+    lia::PVec3f pa[count], pb[count], pc[count], pn[count];
+    float d[count];
+    for (int i = 0; i < count; i++) {
+        a[i] = randVec<float>();
+        b[i] = randVec<float>();
+    }
+    lia::pad(pa, a, count);
+    lia::pad(pb, b, count);
+    lia::cross(pc, pa, pb, count);
+    lia::dot(d, pa, pb, count);
+    lia::normalize(pn, pa, count);
+    lia::pack(back, pa, count);
+    for (int i = 0; i < count; i++) {
+        if (back[i][0] != a[i][0] || back[i][1] != a[i][1] || back[i][2] != a[i][2]) { throw std::runtime_error("Round trip"); }
+        lia::Vec3f c = a[i] ^ b[i];
+        for (int j = 0; j < 3; j++) {
+            if (fabsf(pc[i][j] - c[j]) > 1e-6f) { throw std::runtime_error("Cross"); }
+        }
+        if (fabsf(d[i] - a[i] * b[i]) > 1e-6f) { throw std::runtime_error("Dot"); }
+        if (fabsf(lia::norm(pn[i]) - 1.0f) > 1e-6f) { throw std::runtime_error("Normalize"); }
+    }
+})
\ No newline at end of file
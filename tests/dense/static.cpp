@@ -1,5 +1,6 @@
 #include "../utt/utt.h"
 #include "../../lia/dense/static.h"
+#include <float.h>
 
 template <int ls, int cs>
 static inline lia::SMatd<ls, cs> randMat() {
@@ -50,6 +51,9 @@ UT("Static Transpose 2x2", { testTranspose<2, 2>(); })
 UT("Static Transpose 3x3", { testTranspose<3, 3>(); })
 UT("Static Transpose 4x4", { testTranspose<4, 4>(); })
 UT("Static Transpose 5x5", { testTranspose<5, 5>(); })
+UT("Static Transpose 3x4", { testTranspose<3, 4>(); })
+UT("Static Transpose 8x8", { testTranspose<8, 8>(); })
+UT("Static Transpose 9x9", { testTranspose<9, 9>(); })
 
 template <int d>
 static inline void testNorm() {
@@ -186,6 +190,13 @@ UT("Static Dot 3x3 * 3x3", { testDot<3, 3, 3, 3>(); })
 UT("Static Dot 4x4 * 4x4", { testDot<4, 4, 4, 4>(); })
 UT("Static Dot 5x5 * 5x5", { testDot<5, 5, 5, 5>(); })
 UT("Static Dot 6x5 * 5x3", { testDot<6, 5, 5, 3>(); })
+UT("Static Dot 6x6 * 6x1", { testDot<6, 6, 6, 1>(); })
+UT("Static Dot 3x4 * 4x1", { testDot<3, 4, 4, 1>(); })
+UT("Static Dot 6x6 * 6x6", { testDot<6, 6, 6, 6>(); })
+UT("Static Dot 3x4 * 4x4", { testDot<3, 4, 4, 4>(); })
+UT("Static Dot 8x8 * 8x8", { testDot<8, 8, 8, 8>(); })
+UT("Static Dot 1x8 * 8x7", { testDot<1, 8, 8, 7>(); })
+UT("Static Dot 9x9 * 9x9", { testDot<9, 9, 9, 9>(); })
 
 UT("Static Cross 3x3", {
     lia::Vec3d a = randMat<3, 1>();
@@ -197,4 +208,106 @@ UT("Static Cross 3x3", {
     if (s1 != c[0] || s2 != c[1] || s3 != c[2]) {
         throw std::runtime_error("");
     }
+})
+
+template <int d>
+static inline void testDotFloat() {
+    lia::SVecf<d> a, b;
+    for (int i = 0; i < d; i++) {
+        a[i] = (float)rand() / (float)RAND_MAX;
+        b[i] = (float)rand() / (float)RAND_MAX;
+    }
+    float o = a * b;
+    float sum = 0.0f;
+    for (int i = 0; i < d; i++) {
+        sum += a[i] * b[i];
+    }
+    if (fabsf(o - sum) > 1e-6f) { throw std::runtime_error(""); }
+}
+
+UT("Static Dot Float 2x1 * 2x1", { testDotFloat<2>(); })
+UT("Static Dot Float 3x1 * 3x1", { testDotFloat<3>(); })
+UT("Static Dot Float 4x1 * 4x1", { testDotFloat<4>(); })
+UT("Static Dot Float 5x1 * 5x1", { testDotFloat<5>(); })
+
+// The SIMD paths must not prevent compile time evaluation
+static constexpr float constDot() {
+    lia::Vec4f a = { 1.0f, 2.0f, 3.0f, 4.0f };
+    return a * a;
+}
+static_assert(constDot() == 30.0f, "Compile time dot product");
+
+template <int d>
+static inline void testNormalize() {
+    lia::SVecd<d> a = randMat<d, 1>();
+    lia::SVecd<d> u;
+    lia::normalize(u, a);
+    const double n = lia::norm(a);
+    for (int i = 0; i < d; i++) {
+        if (fabs(u[i] - a[i] / n) > 1e-15) { throw std::runtime_error(""); }
+    }
+}
+
+UT("Static Normalize 3x1", { testNormalize<3>(); })
+UT("Static Normalize 7x1", { testNormalize<7>(); })
+
+UT("Static Distance", {
+    lia::Vec3d a(1.0, 2.0, 3.0);
+    lia::Vec3d b(4.0, 6.0, 3.0);
+    if (lia::distance2(a, b) != 25.0 || lia::distance(a, b) != 5.0) { throw std::runtime_error(""); }
+
+    lia::Vec3d as[5] = { a, a, a, a, a };
+    lia::Vec3d bs[5] = { b, a, b, a, b };
+    double d[5], d2[5];
+    lia::distance(d, as, bs, 5);
+    lia::distance2(d2, as, bs, 5);
+    for (int i = 0; i < 5; i++) {
+        if (d[i] != ((i % 2) ? 0.0 : 5.0) || d2[i] != ((i % 2) ? 0.0 : 25.0)) { throw std::runtime_error("Batch"); }
+    }
+})
+
+UT("Static Reciprocal Square Root Fast", {
+    // The refined estimate must stay within the documented relative error
+    for (int i = 0; i < 100000; i++) {
+        const float x = ldexpf((float)rand() / (float)RAND_MAX + 0.5f, (rand() % 80) - 40);
+        const double exact = 1.0 / sqrt((double)x);
+        if (fabs(lia::rsqrtFast(x) - exact) > 1e-6 * exact) { throw std::runtime_error("Relative error"); }
+    }
+    if (!isinf(lia::rsqrtFast(0.0f))) { throw std::runtime_error("Zero"); }
+
+    // Subnormals must not be flushed to zero and infinity must give zero
+    const float subnormals[4] = { 1e-40f, 1e-39f, 1e-45f, FLT_MIN / 2.0f };
+    for (float x : subnormals) {
+        const double exact = 1.0 / sqrt((double)x);
+        if (fabs(lia::rsqrtFast(x) - exact) > 1e-6 * exact) { throw std::runtime_error("Subnormal"); }
+    }
+    if (lia::rsqrtFast(INFINITY) != 0.0f) { throw std::runtime_error("Infinity"); }
+})
+
+UT("Static Normalize Fast", {
+    const int count = 103;
+    lia::Vec3f v[count], u[count];
+    for (int i = 0; i < count; i++) {
+        v[i] = lia::Vec3f((float)rand() / (float)RAND_MAX + 0.1f, (float)rand() / (float)RAND_MAX - 0.5f, 3.0f * (float)i);
+    }
+    lia::normalizeFast(u, v, count);
+    for (int i = 0; i < count; i++) {
+        lia::Vec3f s;
+        lia::normalizeFast(s, v[i]);
+        if (fabsf(lia::norm(u[i]) - 1.0f) > 2e-6f || fabsf(lia::norm(s) - 1.0f) > 2e-6f) { throw std::runtime_error(""); }
+    }
+
+    // Tiny vectors whose squared norm is subnormal must still normalize, both batched and alone, within the
+    // precision left in the subnormal sum
+    lia::Vec3f t[4] = { lia::Vec3f(1e-20f, 0.0f, 0.0f), lia::Vec3f(0.0f, 2e-20f, 0.0f), lia::Vec3f(0.0f, 0.0f, -3e-20f), lia::Vec3f(1e-20f, 0.0f, 0.0f) };
+    lia::Vec3f tu[4];
+    lia::normalizeFast(tu, t, 4);
+    for (int i = 0; i < 4; i++) {
+        lia::Vec3f s;
+        lia::normalizeFast(s, t[i]);
+        for (int k = 0; k < 3; k++) {
+            const float ref = (t[i][k] > 0.0f) ? 1.0f : ((t[i][k] < 0.0f) ? -1.0f : 0.0f);
+            if (fabsf(tu[i][k] - ref) > 1e-5f || fabsf(s[k] - ref) > 1e-5f) { throw std::runtime_error("Tiny vector"); }
+        }
+    }
 })
\ No newline at end of file
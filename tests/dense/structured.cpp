@@ -0,0 +1,147 @@
+#include "../utt/utt.h"
+#include "../../lia/dense/structured.h"
+#include <math.h>
+
+static inline double randValue() {
+    return (double)rand() / (double)RAND_MAX;
+}
+
+static inline void randFill(lia::DMatd& mat) {
+    for (int i = 0; i < mat.ls*mat.cs; i++) { mat[i] = randValue(); }
+}
+
+static inline void checkClose(const lia::DMatd& a, const lia::DMatd& b, double tol) {
+    for (int i = 0; i < a.ls*a.cs; i++) {
+        if (fabs(a[i] - b[i]) > tol) { throw std::runtime_error(""); }
+    }
+}
+
+UT("Structured Symmetric", {
+    const int n = 37;
+    lia::SymMatd s(n);
+    for (int i = 0; i < n*(n + 1)/2; i++) { s.data()[i] = randValue(); }
+    if (s(3, 17) != s(17, 3)) { throw std::runtime_error("Mirror"); }
+    lia::DMatd dense(n, n);
+    lia::toMat(dense, s);
+    lia::SymMatd back(n);
+    lia::fromMat(back, dense);
+    for (int i = 0; i < n*(n + 1)/2; i++) {
+        if (back.data()[i] != s.data()[i]) { throw std::runtime_error("Round trip"); }
+    }
+
+    // SYMV and SYMM against the dense product
+    lia::DVecd x(n), y(n), ref(n);
+    randFill(x);
+    lia::dot(y, s, x);
+    lia::dot(ref, dense, x);
+    checkClose(y, ref, 1e-12);
+    lia::DMatd b(n, 5), r(n, 5), rref(n, 5);
+    randFill(b);
+    lia::dot(r, s, b);
+    lia::dot(rref, dense, b);
+    checkClose(r, rref, 1e-12);
+
+    // SYRK against the dense product with the transpose
+    lia::DMatd a(n, 11), at(11, n), aat(n, n), full(n, n);
+    randFill(a);
+    lia::transpose(at, a);
+    lia::dot(aat, a, at);
+    lia::SymMatd g(n);
+    lia::syrk(g, a);
+    lia::toMat(full, g);
+    checkClose(full, aat, 1e-12);
+})
+
+UT("Structured Triangular", {
+    const int n = 29;
+    for (int u = 0; u < 2; u++) {
+        lia::TriMatd t(n, u ? lia::UPLO_UPPER : lia::UPLO_LOWER);
+        for (int i = 0; i < n*(n + 1)/2; i++) { t.data()[i] = randValue() + 1.0; }
+        if (t.get(u ? 5 : 1, u ? 1 : 5) != 0.0) { throw std::runtime_error("Outside"); }
+        lia::DMatd dense(n, n);
+        lia::toMat(dense, t);
+
+        lia::DVecd x(n), y(n), ref(n);
+        randFill(x);
+        lia::dot(y, t, x);
+        lia::dot(ref, dense, x);
+        checkClose(y, ref, 1e-12);
+
+        lia::DMatd b(n, 4), r(n, 4), rref(n, 4);
+        randFill(b);
+        lia::dot(r, t, b);
+        lia::dot(rref, dense, b);
+        checkClose(r, rref, 1e-12);
+
+        // Solving the products gives back the original vector and matrix, in place as well
+        lia::DVecd sx(n);
+        lia::solve(sx, t, y);
+        checkClose(sx, x, 1e-9);
+        lia::solve(r, t, r);
+        checkClose(r, b, 1e-9);
+    }
+})
+
+UT("Structured Banded", {
+    const int n = 50;
+    for (int kl = 1; kl <= 3; kl++) {
+        const int ku = (kl == 1) ? 1 : kl - 1;
+        lia::BandMatd m(n, kl, ku);
+        for (int i = 0; i < n; i++) {
+            for (int j = std::max(0, i - kl); j < std::min(n, i + ku + 1); j++) {
+                m(i, j) = (i == j) ? 10.0 + randValue() : randValue();
+            }
+        }
+        lia::DMatd dense(n, n);
+        lia::toMat(dense, m);
+        lia::BandMatd back(n, kl, ku);
+        lia::fromMat(back, dense);
+        if (back.get(0, n - 1) != 0.0 || back(n - 1, n - 1) != m(n - 1, n - 1)) { throw std::runtime_error("Round trip"); }
+
+        lia::DVecd x(n), y(n), ref(n);
+        randFill(x);
+        lia::dot(y, m, x);
+        lia::dot(ref, dense, x);
+        checkClose(y, ref, 1e-12);
+
+        lia::DMatd b(n, 3), r(n, 3), rref(n, 3);
+        randFill(b);
+        lia::dot(r, m, b);
+        lia::dot(rref, dense, b);
+        checkClose(r, rref, 1e-12);
+
+        // Tridiagonal systems go through the Thomas algorithm, wider bands through LU
+        lia::DVecd sx(n);
+        lia::solve(sx, m, y);
+        checkClose(sx, x, 1e-12);
+    }
+
+    lia::BandMatd singular(3, 1, 1);
+    for (int i = 0; i < 9; i++) { singular.data()[i] = 0.0; }
+    lia::DVecd b(3), x(3);
+    bool thrown = false;
+    try { lia::solve(x, singular, b); } catch (const std::runtime_error&) { thrown = true; }
+    if (!thrown) { throw std::runtime_error("Zero pivot"); }
+})
+
+UT("Structured Column-Major", {
+    // Kernels walking dense lines must reject column-major matrices instead of misreading them
+    lia::SymMatd s(3);
+    for (int i = 0; i < 6; i++) { s.data()[i] = randValue(); }
+    lia::TriMatd t(3, lia::UPLO_LOWER);
+    for (int i = 0; i < 6; i++) { t.data()[i] = randValue() + 1.0; }
+    lia::DMatd b(3, 2, lia::LAYOUT_COLUMN_MAJOR), r(3, 2), c(3, 2, lia::LAYOUT_COLUMN_MAJOR);
+    randFill(b);
+    lia::SymMatd g(3);
+    int thrown = 0;
+    try { lia::dot(r, s, b); } catch (const std::invalid_argument&) { thrown++; }
+    try { lia::dot(c, s, r); } catch (const std::invalid_argument&) { thrown++; }
+    try { lia::solve(r, t, b); } catch (const std::invalid_argument&) { thrown++; }
+    try { lia::syrk(g, b); } catch (const std::invalid_argument&) { thrown++; }
+    if (thrown != 4) { throw std::runtime_error("Layout check"); }
+
+    // Column-major vectors have the same storage and are accepted
+    lia::DMatd x(3, 1, lia::LAYOUT_COLUMN_MAJOR), y(3, 1);
+    randFill(x);
+    lia::dot(y, s, x);
+})
\ No newline at end of file
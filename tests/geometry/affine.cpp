@@ -0,0 +1,80 @@
+#include "../utt/utt.h"
+#include "../../lia/geometry/affine.h"
+
+static inline lia::Affined randAffine() {
+    lia::SMatd<3, 4> m;
+    for (int i = 0; i < 12; i++) {
+        m[i] = (double)rand() / (double)RAND_MAX - 0.5;
+    }
+    m(0, 0) += 2.0; m(1, 1) += 2.0; m(2, 2) += 2.0;
+    return lia::Affined(m);
+}
+
+static inline bool near(const lia::Vec3d& a, const lia::Vec3d& b) {
+    return fabs(a[0] - b[0]) < 1e-12 && fabs(a[1] - b[1]) < 1e-12 && fabs(a[2] - b[2]) < 1e-12;
+}
+
+UT("Affine Compose", {
+    for (int n = 0; n < 100; n++) {
+        lia::Affined a = randAffine();
+        lia::Affined b = randAffine();
+
+        // Must match the full homogeneous product
+        lia::Mat4d ma, mb, mc;
+        lia::toMat(ma, a);
+        lia::toMat(mb, b);
+        lia::toMat(mc, a * b);
+        lia::Mat4d ref = ma * mb;
+        for (int i = 0; i < 16; i++) {
+            if (fabs(mc[i] - ref[i]) > 1e-12) { throw std::runtime_error(""); }
+        }
+    }
+})
+
+UT("Affine Apply", {
+    lia::Affined a = randAffine();
+    lia::Vec3d v(0.3, -1.2, 2.0);
+    lia::Mat4d m;
+    lia::toMat(m, a);
+    lia::Vec4d p = m * lia::Vec4d(v[0], v[1], v[2], 1.0);
+    lia::Vec4d d = m * lia::Vec4d(v[0], v[1], v[2], 0.0);
+    lia::Vec3d rd;
+    lia::applyDirection(rd, a, v);
+    if (!near(a * v, lia::Vec3d(p[0], p[1], p[2]))) { throw std::runtime_error("Point"); }
+    if (!near(rd, lia::Vec3d(d[0], d[1], d[2]))) { throw std::runtime_error("Direction"); }
+
+    // Batched versions
+    lia::Vec3d vs[10], ps[10], ds[10];
+    for (int i = 0; i < 10; i++) { vs[i] = lia::Vec3d(i, -i, 0.5*i); }
+    lia::apply(ps, a, vs, 10);
+    lia::applyDirection(ds, a, vs, 10);
+    for (int i = 0; i < 10; i++) {
+        lia::applyDirection(rd, a, vs[i]);
+        if (!near(ps[i], a * vs[i]) || !near(ds[i], rd)) { throw std::runtime_error("Batch"); }
+    }
+})
+
+UT("Affine Inverse", {
+    for (int n = 0; n < 100; n++) {
+        lia::Affined a = randAffine();
+        lia::Affined inv;
+        lia::invert(inv, a);
+        lia::Affined id = inv * a;
+        lia::Affined ref = lia::Affined::identity();
+        for (int i = 0; i < 12; i++) {
+            if (fabs(id.mat[i] - ref.mat[i]) > 1e-12) { throw std::runtime_error(""); }
+        }
+    }
+
+    // Rigid transforms can be inverted by transposition
+    lia::Vec3d axis(1.0, 2.0, 3.0);
+    axis /= lia::norm(axis);
+    lia::Affined a;
+    lia::fromTransform(a, lia::Transformd(lia::Quatd::axisAngle(axis, 0.7), lia::Vec3d(1.0, 2.0, 3.0)));
+    lia::Affined i1, i2;
+    lia::invert(i1, a);
+    lia::invertRigid(i2, a);
+    for (int i = 0; i < 12; i++) {
+        if (fabs(i1.mat[i] - i2.mat[i]) > 1e-12) { throw std::runtime_error("Rigid"); }
+    }
+})
\ No newline at end of file
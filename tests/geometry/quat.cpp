@@ -0,0 +1,126 @@
+#include "../utt/utt.h"
+#include "../../lia/geometry/quat.h"
+
+template <typename T>
+static inline lia::Quat<T> randQuat() {
+    lia::SVec<3, T> axis((T)rand() / (T)RAND_MAX - (T)0.5, (T)rand() / (T)RAND_MAX - (T)0.5, (T)rand() / (T)RAND_MAX - (T)0.5);
+    axis /= lia::norm(axis);
+    return lia::Quat<T>::axisAngle(axis, (T)rand() / (T)RAND_MAX * (T)6);
+}
+
+template <typename T>
+static inline lia::SVec<3, T> randVec() {
+    return lia::SVec<3, T>((T)rand() / (T)RAND_MAX, (T)rand() / (T)RAND_MAX, (T)rand() / (T)RAND_MAX);
+}
+
+template <int ls, int cs, typename T>
+static inline bool near(const lia::SMat<ls, cs, T>& a, const lia::SMat<ls, cs, T>& b, T tol) {
+    for (int i = 0; i < ls*cs; i++) {
+        if (fabs(a[i] - b[i]) > tol) { return false; }
+    }
+    return true;
+}
+
+// Quaternions q and -q are the same rotation
+template <typename T>
+static inline bool near(const lia::Quat<T>& a, const lia::Quat<T>& b, T tol) {
+    bool same = true, opposite = true;
+    for (int i = 0; i < 4; i++) {
+        same &= fabs(a[i] - b[i]) <= tol;
+        opposite &= fabs(a[i] + b[i]) <= tol;
+    }
+    return same || opposite;
+}
+
+UT("Quat Axis Angle", {
+    lia::Quatd q = lia::Quatd::axisAngle(lia::Vec3d(0, 0, 1), M_PI / 2);
+    lia::Vec3d v = q * lia::Vec3d(1, 0, 0);
+    if (!near(v, lia::Vec3d(0, 1, 0), 1e-12)) { throw std::runtime_error(""); }
+})
+
+template <typename T>
+static inline void testQuatCompose(T tol) {
+    for (int n = 0; n < 100; n++) {
+        lia::Quat<T> a = randQuat<T>();
+        lia::Quat<T> b = randQuat<T>();
+        lia::SVec<3, T> v = randVec<T>();
+
+        // Composition must match applying both rotations and the matrix product
+        lia::SVec<3, T> r1 = (a * b) * v;
+        lia::SVec<3, T> r2 = a * (b * v);
+        lia::SMat<3, 3, T> ma, mb;
+        lia::toMat(ma, a);
+        lia::toMat(mb, b);
+        lia::SVec<3, T> r3 = (ma * mb) * v;
+        if (!near(r1, r2, tol) || !near(r1, r3, tol)) { throw std::runtime_error(""); }
+
+        // The conjugate must undo the rotation
+        if (!near(~a * (a * v), v, tol)) { throw std::runtime_error("Inverse"); }
+    }
+}
+
+UT("Quat Compose Double", { testQuatCompose<double>(1e-12); })
+UT("Quat Compose Float", { testQuatCompose<float>(1e-5f); })
+
+template <typename T>
+static inline void testQuatBatch(T tol) {
+    const int count = 37;
+    lia::Quat<T> a[count], b[count], r[count];
+    lia::SVec<3, T> v[count], rv[count];
+    for (int i = 0; i < count; i++) {
+        a[i] = randQuat<T>();
+        b[i] = randQuat<T>();
+        v[i] = randVec<T>();
+    }
+    lia::mul(r, a, b, count);
+    lia::rotate(rv, a, v, count);
+    for (int i = 0; i < count; i++) {
+        if (!near(r[i], a[i] * b[i], tol)) { throw std::runtime_error("Product"); }
+        if (!near(rv[i], a[i] * v[i], tol)) { throw std::runtime_error("Rotation"); }
+    }
+}
+
+UT("Quat Batch Double", { testQuatBatch<double>(1e-12); })
+UT("Quat Batch Float", { testQuatBatch<float>(1e-6f); })
+
+UT("Quat Matrix Conversion", {
+    for (int n = 0; n < 1000; n++) {
+        lia::Quatd q = randQuat<double>();
+        lia::Mat3d m;
+        lia::toMat(m, q);
+        lia::Quatd p;
+        lia::fromMat(p, m);
+        if (!near(p, q, 1e-9)) { throw std::runtime_error(""); }
+    }
+
+    // Rotations by pi exercise the non-trace branches
+    for (int axis = 0; axis < 3; axis++) {
+        lia::Vec3d u(0, 0, 0);
+        u[axis] = 1;
+        lia::Quatd q = lia::Quatd::axisAngle(u, M_PI);
+        lia::Mat3d m;
+        lia::toMat(m, q);
+        lia::Quatd p;
+        lia::fromMat(p, m);
+        if (!near(p, q, 1e-9)) { throw std::runtime_error("Half turn"); }
+    }
+})
+
+UT("Quat Interpolation", {
+    lia::Vec3d axis(0, 1, 0);
+    lia::Quatd a = lia::Quatd::axisAngle(axis, 0.2);
+    lia::Quatd b = lia::Quatd::axisAngle(axis, 1.4);
+    lia::Quatd r;
+
+    // Slerp moves at constant angular velocity
+    lia::slerp(r, a, b, 0.25);
+    if (!near(r, lia::Quatd::axisAngle(axis, 0.5), 1e-12)) { throw std::runtime_error("Slerp"); }
+
+    // Both must hit the end points and take the shortest path
+    lia::Quatd nb = { -b[0], -b[1], -b[2], -b[3] };
+    lia::slerp(r, a, nb, 1.0);
+    if (!near(r, b, 1e-12)) { throw std::runtime_error("Slerp shortest path"); }
+    lia::nlerp(r, a, nb, 0.5);
+    if (!near(r, lia::Quatd::axisAngle(axis, 0.8), 1e-12)) { throw std::runtime_error("Nlerp"); }
+    if (fabs(lia::norm(r) - 1.0) > 1e-12) { throw std::runtime_error("Nlerp norm"); }
+})
\ No newline at end of file
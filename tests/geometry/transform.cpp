@@ -0,0 +1,63 @@
+#include "../utt/utt.h"
+#include "../../lia/geometry/transform.h"
+
+static inline lia::Transformd randTransform() {
+    lia::Vec3d axis((double)rand() / (double)RAND_MAX - 0.5, (double)rand() / (double)RAND_MAX - 0.5, (double)rand() / (double)RAND_MAX - 0.5);
+    axis /= lia::norm(axis);
+    lia::Quatd rot = lia::Quatd::axisAngle(axis, (double)rand() / (double)RAND_MAX * 6.0);
+    lia::Vec3d trans((double)rand() / (double)RAND_MAX, (double)rand() / (double)RAND_MAX, (double)rand() / (double)RAND_MAX);
+    return lia::Transformd(rot, trans);
+}
+
+static inline bool near(const lia::Vec3d& a, const lia::Vec3d& b) {
+    return fabs(a[0] - b[0]) < 1e-12 && fabs(a[1] - b[1]) < 1e-12 && fabs(a[2] - b[2]) < 1e-12;
+}
+
+UT("Transform Compose", {
+    for (int n = 0; n < 100; n++) {
+        lia::Transformd a = randTransform();
+        lia::Transformd b = randTransform();
+        lia::Vec3d v(1.0, -2.0, 0.5);
+
+        // Composition must match applying both transforms and the homogeneous matrix product
+        lia::Vec3d r1 = (a * b) * v;
+        lia::Vec3d r2 = a * (b * v);
+        lia::Mat4d ma, mb;
+        lia::toMat(ma, a);
+        lia::toMat(mb, b);
+        lia::Vec4d h = (ma * mb) * lia::Vec4d(v[0], v[1], v[2], 1.0);
+        if (!near(r1, r2) || !near(r1, lia::Vec3d(h[0], h[1], h[2]))) { throw std::runtime_error(""); }
+
+        // The inverse must undo the transform
+        lia::Transformd inv;
+        lia::invert(inv, a);
+        if (!near(inv * (a * v), v)) { throw std::runtime_error("Inverse"); }
+    }
+})
+
+UT("Transform Batch", {
+    const int count = 20;
+    lia::Transformd a[count], b[count], r[count];
+    lia::Vec3d v[count], rv[count];
+    for (int i = 0; i < count; i++) {
+        a[i] = randTransform();
+        b[i] = randTransform();
+        v[i] = lia::Vec3d(i, 1.0, -i);
+    }
+    lia::mul(r, a, b, count);
+    lia::apply(rv, a, v, count);
+    for (int i = 0; i < count; i++) {
+        if (!near(r[i] * v[i], a[i] * (b[i] * v[i]))) { throw std::runtime_error("Composition"); }
+        if (!near(rv[i], a[i] * v[i])) { throw std::runtime_error("Application"); }
+    }
+})
+
+UT("Transform Matrix Conversion", {
+    lia::Transformd a = randTransform();
+    lia::Mat4d m;
+    lia::toMat(m, a);
+    lia::Transformd b;
+    lia::fromMat(b, m);
+    lia::Vec3d v(0.3, 0.2, 0.1);
+    if (!near(a * v, b * v)) { throw std::runtime_error(""); }
+})
\ No newline at end of file
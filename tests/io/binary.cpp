@@ -0,0 +1,122 @@
+#include "../utt/utt.h"
+#include "../../lia/io/binary.h"
+#include <stdio.h>
+#include <limits.h>
+
+UT("Binary Save/Map", {
+    lia::DMatd a(69, 42);
+    for (int i = 0; i < 69*42; i++) {
+        a[i] = (double)rand() / (double)RAND_MAX;
+    }
+    lia::save("lia_test_binary.bin", a);
+    {
+        lia::MappedDMat<double> b("lia_test_binary.bin", true);
+        if (b->ls != 69 || b->cs != 42) { throw std::runtime_error("Wrong shape"); }
+        if ((uintptr_t)b->data() % 64) { throw std::runtime_error("Payload not aligned"); }
+        for (int i = 0; i < 69*42; i++) {
+            if ((*b)[i] != a[i]) { throw std::runtime_error("Wrong data"); }
+        }
+    }
+    remove("lia_test_binary.bin");
+})
+
+UT("Binary Type Mismatch", {
+    lia::DMatf a(3, 3);
+    lia::clear(a, 1.0f);
+    lia::save("lia_test_binary_type.bin", a);
+    bool thrown = false;
+    try {
+        lia::MappedDMat<double> b("lia_test_binary_type.bin");
+    }
+    catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    remove("lia_test_binary_type.bin");
+    if (!thrown) { throw std::runtime_error(""); }
+})
+
+UT("Binary Checksum", {
+    lia::DMati a(16, 16);
+    lia::clear(a, 42);
+    lia::save("lia_test_binary_checksum.bin", a);
+
+    // Corrupt the last element of the payload
+    FILE* fp = fopen("lia_test_binary_checksum.bin", "r+b");
+    fseek(fp, -1, SEEK_END);
+    fputc(0x55, fp);
+    fclose(fp);
+
+    // Mapping without verification must succeed, verification must fail
+    { lia::MappedDMat<int> b("lia_test_binary_checksum.bin"); }
+    bool thrown = false;
+    try {
+        lia::MappedDMat<int> b("lia_test_binary_checksum.bin", true);
+    }
+    catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    remove("lia_test_binary_checksum.bin");
+    if (!thrown) { throw std::runtime_error(""); }
+})
+
+UT("Binary Header Range", {
+    lia::DMatf a(2, 2);
+    lia::clear(a, 1.0f);
+    lia::save("lia_test_binary_range.bin", a);
+    lia::BinaryHeader hdr;
+    FILE* fp = fopen("lia_test_binary_range.bin", "rb");
+    const bool ok = (fread(&hdr, sizeof(lia::BinaryHeader), 1, fp) == 1);
+    fclose(fp);
+    remove("lia_test_binary_range.bin");
+    if (!ok || lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Valid header"); }
+
+    // Sizes that don't fit in an int, even with a consistent payload size, must be rejected
+    hdr.lines = (int64_t)INT_MAX + 1;
+    hdr.columns = 0;
+    hdr.size = 0;
+    if (!lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Lines"); }
+    hdr.lines = -2;
+    hdr.columns = -2;
+    hdr.size = 16;
+    if (!lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Negative"); }
+
+    // Element counts whose byte size wraps around must not match a small payload
+    hdr.lines = INT_MAX;
+    hdr.columns = INT_MAX;
+    if (!lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Overflow"); }
+
+    // Dimensions that fit in an int but whose element count doesn't, with a consistent payload size
+    hdr.lines = 65536;
+    hdr.columns = 65536;
+    hdr.size = (uint64_t)65536 * 65536 * sizeof(float);
+    if (!lia::checkHeader<float>(hdr, 64 + hdr.size)) { throw std::runtime_error("Element count"); }
+
+    // The payload must not overlap the header
+    hdr.lines = 2;
+    hdr.columns = 2;
+    hdr.size = 16;
+    if (lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Valid header"); }
+    hdr.offset = 0;
+    if (!lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Offset"); }
+    hdr.offset = 32;
+    if (!lia::checkHeader<float>(hdr, 64 + 16)) { throw std::runtime_error("Offset"); }
+})
+
+UT("Binary Column-Major", {
+    lia::DMatd a(13, 7, lia::LAYOUT_COLUMN_MAJOR);
+    for (int i = 0; i < 13*7; i++) {
+        a[i] = (double)rand() / (double)RAND_MAX;
+    }
+    lia::save("lia_test_binary_cm.bin", a);
+    {
+        // The payload is always row-major
+        lia::MappedDMat<double> b("lia_test_binary_cm.bin", true);
+        if (b->ls != 13 || b->cs != 7) { throw std::runtime_error("Wrong shape"); }
+        for (int i = 0; i < 13; i++) {
+            for (int j = 0; j < 7; j++) {
+                if ((*b)(i, j) != a(i, j)) { throw std::runtime_error("Wrong data"); }
+            }
+        }
+    }
+    remove("lia_test_binary_cm.bin");
+})
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "../utt/utt.h"
+#include "../../lia/io/stream.h"
+#include "../../lia/io/binary.h"
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+#include <stddef.h>
+
+static inline lia::DMatd streamMat() {
+    lia::DMatd mat(1000, 37);
+    for (int i = 0; i < 1000*37; i++) {
+        mat[i] = (double)rand() / (double)RAND_MAX;
+    }
+    return mat;
+}
+
+UT("Stream Dot(Mat * Vec)", {
+    lia::DMatd a = streamMat();
+    lia::DVecd b(37);
+    for (int i = 0; i < 37; i++) { b[i] = (double)rand() / (double)RAND_MAX; }
+    lia::save("lia_test_stream_dot.bin", a);
+    lia::DVecd c(1000);
+    lia::DVecd d(1000);
+    {
+        lia::StreamedDMat<double> s("lia_test_stream_dot.bin", 64);
+        lia::dot(c, s, b);
+    }
+    remove("lia_test_stream_dot.bin");
+    lia::dot(d, a, b);
+    for (int i = 0; i < 1000; i++) {
+        if (c[i] != d[i]) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Stream TDot(Mat^T * Vec)", {
+    lia::DMatd a = streamMat();
+    lia::DVecd b(1000);
+    for (int i = 0; i < 1000; i++) { b[i] = (double)rand() / (double)RAND_MAX; }
+    lia::save("lia_test_stream_tdot.bin", a);
+    lia::DVecd c(37);
+    {
+        lia::StreamedDMat<double> s("lia_test_stream_tdot.bin", 100);
+        lia::tdot(c, s, b);
+    }
+    remove("lia_test_stream_tdot.bin");
+    for (int j = 0; j < 37; j++) {
+        double sum = 0.0;
+        for (int i = 0; i < 1000; i++) {
+            sum += a(i, j) * b[i];
+        }
+        if (fabs(c[j] - sum) > 1e-9 * fabs(sum)) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Stream Gram(Mat^T * Mat)", {
+    lia::DMatd a = streamMat();
+    lia::save("lia_test_stream_gram.bin", a);
+    lia::DMatd c(37, 37);
+    {
+        lia::StreamedDMat<double> s("lia_test_stream_gram.bin", 128);
+        lia::gram(c, s);
+    }
+    remove("lia_test_stream_gram.bin");
+    for (int j = 0; j < 37; j++) {
+        for (int k = 0; k < 37; k++) {
+            double sum = 0.0;
+            for (int i = 0; i < 1000; i++) {
+                sum += a(i, j) * a(i, k);
+            }
+            if (fabs(c(j, k) - sum) > 1e-9 * fabs(sum)) { throw std::runtime_error(""); }
+        }
+    }
+})
+
+UT("Stream Header Range", {
+    lia::DMatd a(4, 4);
+    lia::clear(a, 1.0);
+    lia::save("lia_test_stream_range.bin", a);
+
+    // Patch the number of lines with a value that doesn't fit in an int
+    const int64_t lines = (int64_t)INT_MAX + 1;
+    FILE* fp = fopen("lia_test_stream_range.bin", "r+b");
+    fseek(fp, offsetof(lia::BinaryHeader, lines), SEEK_SET);
+    fwrite(&lines, sizeof(int64_t), 1, fp);
+    fclose(fp);
+
+    bool thrown = false;
+    try {
+        lia::StreamedDMat<double> s("lia_test_stream_range.bin");
+    }
+    catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    remove("lia_test_stream_range.bin");
+    if (!thrown) { throw std::runtime_error(""); }
+})
+
+UT("Stream Panel Size", {
+    lia::DMatd a = streamMat();
+    lia::DVecd b(37);
+    for (int i = 0; i < 37; i++) { b[i] = (double)rand() / (double)RAND_MAX; }
+    lia::save("lia_test_stream_panel.bin", a);
+    lia::DVecd c(1000);
+    lia::DVecd d(1000);
+    {
+        // Panels whose element count doesn't fit in an int get clamped
+        lia::StreamedDMat<double> s("lia_test_stream_panel.bin", INT_MAX);
+        if ((int64_t)s.panel * s.cs > INT_MAX) { throw std::runtime_error("Panel"); }
+        lia::dot(c, s, b);
+    }
+    remove("lia_test_stream_panel.bin");
+    lia::dot(d, a, b);
+    for (int i = 0; i < 1000; i++) {
+        if (c[i] != d[i]) { throw std::runtime_error(""); }
+    }
+})
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "../utt/utt.h"
+#include "../../lia/io/text.h"
+#include <stdio.h>
+#include <string.h>
+
+UT("Text Save/Load Round Trip", {
+    lia::DMatd a(513, 17);
+    for (int i = 0; i < 513*17; i++) {
+        a[i] = ((double)rand() / (double)RAND_MAX - 0.5) * 1e6;
+    }
+    lia::saveText("lia_test_text.csv", a);
+    lia::DMatd b = lia::loadText<double>("lia_test_text.csv");
+    remove("lia_test_text.csv");
+    if (b.ls != 513 || b.cs != 17) { throw std::runtime_error("Wrong shape"); }
+    for (int i = 0; i < 513*17; i++) {
+        if (a[i] != b[i]) { throw std::runtime_error("Wrong data"); }
+    }
+})
+
+UT("Text Load Whitespace", {
+    const char* text = "\n  1.5 -2\t+3e2\r\n\n4, 5 ,6\n7;8;-9.25";
+    FILE* fp = fopen("lia_test_text_ws.txt", "wb");
+    fwrite(text, 1, strlen(text), fp);
+    fclose(fp);
+    lia::DMatf a = lia::loadText<float>("lia_test_text_ws.txt");
+    remove("lia_test_text_ws.txt");
+    const float ref[9] = { 1.5f, -2.0f, 300.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, -9.25f };
+    if (a.ls != 3 || a.cs != 3) { throw std::runtime_error("Wrong shape"); }
+    for (int i = 0; i < 9; i++) {
+        if (a[i] != ref[i]) { throw std::runtime_error("Wrong data"); }
+    }
+})
+
+UT("Text Load Ragged", {
+    const char* text = "1 2 3\n4 5\n";
+    FILE* fp = fopen("lia_test_text_ragged.txt", "wb");
+    fwrite(text, 1, strlen(text), fp);
+    fclose(fp);
+    bool thrown = false;
+    try {
+        lia::DMati a = lia::loadText<int>("lia_test_text_ragged.txt");
+    }
+    catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    remove("lia_test_text_ragged.txt");
+    if (!thrown) { throw std::runtime_error(""); }
+})
+
+UT("Text Load Empty Fields", {
+    const char* texts[5] = { "1,,2\n", ",1,2\n", "1,2,\n", "1, ,2\n3,4,5\n", "1 2\n3;;4\n" };
+    for (int i = 0; i < 5; i++) {
+        FILE* fp = fopen("lia_test_text_empty.txt", "wb");
+        fwrite(texts[i], 1, strlen(texts[i]), fp);
+        fclose(fp);
+        bool thrown = false;
+        try {
+            lia::DMati a = lia::loadText<int>("lia_test_text_empty.txt");
+        }
+        catch (const std::runtime_error& e) {
+            thrown = true;
+        }
+        remove("lia_test_text_empty.txt");
+        if (!thrown) { throw std::runtime_error(texts[i]); }
+    }
+})
+
+UT("Text Save Column-Major", {
+    lia::DMati a(5, 3, lia::LAYOUT_COLUMN_MAJOR);
+    for (int i = 0; i < 15; i++) { a[i] = i; }
+    lia::saveText("lia_test_text_cm.csv", a);
+    lia::DMati b = lia::loadText<int>("lia_test_text_cm.csv");
+    remove("lia_test_text_cm.csv");
+    if (b.ls != 5 || b.cs != 3) { throw std::runtime_error("Wrong shape"); }
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (b(i, j) != a(i, j)) { throw std::runtime_error("Wrong data"); }
+        }
+    }
+})
+
+UT("Text Load Malformed Numbers", {
+    const char* texts[7] = { "1-2\n", "+-1\n", "1.5x\n", "1 2\n3-4\n", "1 2\n+-1 5\n", "1 +\n", "1 2\n3 4.5.6\n" };
+    for (int i = 0; i < 7; i++) {
+        FILE* fp = fopen("lia_test_text_malformed.txt", "wb");
+        fwrite(texts[i], 1, strlen(texts[i]), fp);
+        fclose(fp);
+        bool thrown = false;
+        try {
+            lia::DMatf a = lia::loadText<float>("lia_test_text_malformed.txt");
+        }
+        catch (const std::runtime_error& e) {
+            thrown = true;
+        }
+        remove("lia_test_text_malformed.txt");
+        if (!thrown) { throw std::runtime_error(texts[i]); }
+    }
+})
\ No newline at end of file
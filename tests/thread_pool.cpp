@@ -0,0 +1,80 @@
+#include "utt/utt.h"
+#include "../lia/thread_pool.h"
+#include <atomic>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+UT("Thread Pool Partition", {
+    for (int chunks = 1; chunks < 9; chunks++) {
+        int expected = 0;
+        for (int id = 0; id < chunks; id++) {
+            int begin, end;
+            lia::partition(103, chunks, id, begin, end);
+            if (begin != expected || end - begin < 103 / chunks || end - begin > 103 / chunks + 1) {
+                throw std::runtime_error("");
+            }
+            expected = end;
+        }
+        if (expected != 103) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Thread Pool Parallel For", {
+    std::vector<int> hits(100000, 0);
+    lia::parallelFor(100000, 1000, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) { hits[i]++; }
+    });
+    for (int h : hits) {
+        if (h != 1) { throw std::runtime_error(""); }
+    }
+})
+
+UT("Thread Pool Nested", {
+    lia::ThreadPool pool(4);
+    std::atomic<int> count(0);
+    pool.run(8, [&](int) {
+        pool.run(8, [&](int) { count++; });
+    });
+    if (count != 64) { throw std::runtime_error(""); }
+})
+
+UT("Thread Pool Exceptions", {
+    lia::ThreadPool pool(4);
+    bool thrown = false;
+    try {
+        pool.run(16, [](int id) {
+            if (id == 7) { throw std::runtime_error("Task failed"); }
+        });
+    }
+    catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    if (!thrown) { throw std::runtime_error(""); }
+})
+
+UT("Thread Pool Try Run", {
+    lia::ThreadPool pool(4);
+    std::atomic<int> count(0);
+    std::atomic<int> refused(0);
+    if (!pool.tryRun(8, [&](int) {
+        // Nested jobs can't run on the workers and must not be run inline either
+        if (!pool.tryRun(8, [&](int) { count++; })) { refused++; }
+    })) {
+        throw std::runtime_error("Refused");
+    }
+    if (count != 0 || refused != 8) { throw std::runtime_error(""); }
+})
+
+UT("Thread Pool Pin", {
+#ifdef __linux__
+    // Only the workers may get pinned, never the calling thread
+    cpu_set_t before, after;
+    sched_getaffinity(0, sizeof(cpu_set_t), &before);
+    lia::ThreadPool pool(4);
+    pool.pin();
+    pool.run(8, [](int) {});
+    sched_getaffinity(0, sizeof(cpu_set_t), &after);
+    if (!CPU_EQUAL(&before, &after)) { throw std::runtime_error(""); }
+#endif
+})
\ No newline at end of file
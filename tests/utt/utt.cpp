@@ -1,6 +1,7 @@
 #include "utt.h"
 #include <stdio.h>
 #include <algorithm>
+#include <string.h>
 
 int main() {
     // Go through each test